@@ -0,0 +1,227 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+// Microbenchmark of the native trace ingestion path (RegisterCallbackTraceBinary + RegisterCallbackExit) without a
+// server: every op is one traced callback, its enter record and its exit, issued from 1 to 32 producer threads.
+//
+// Usage: trace_bench [ops per thread] [ring capacity]
+//
+#include "callback_ingest.h"
+#include "callback_trace.h"
+#include "names.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using acceleratorcss::ArgTag;
+using acceleratorcss::CallbackFrame;
+using acceleratorcss::CallbackIngest;
+using acceleratorcss::CallbackTrace;
+using acceleratorcss::CallbackTraceRecord;
+using acceleratorcss::MonotonicNs;
+using acceleratorcss::NameTable;
+
+namespace {
+    std::atomic<uint64_t> g_Allocations{0};
+
+    constexpr int kThreadCounts[] = {1, 2, 8, 32};
+    constexpr size_t kMethods = 64;
+    constexpr size_t kWarmupOps = 10'000;
+
+    struct Payload {
+        const char *name;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Result {
+        uint64_t ops;
+        uint64_t cpuNs;
+        uint64_t wallNs;
+        uint64_t allocations;
+        uint64_t p50Ns;
+        uint64_t p99Ns;
+    };
+
+    uint32_t g_MethodIds[kMethods];
+
+    // CPU time rather than wall time, so ns/op stays meaningful with more producers than cores.
+    uint64_t ThreadCpuNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    void WriteHeader(std::vector<uint8_t> &bytes, uint32_t methodId, uint16_t argsLen, uint16_t frameCount) {
+        const int32_t managedTid = 1;
+        std::memcpy(bytes.data(), &methodId, sizeof(methodId));
+        std::memcpy(bytes.data() + 4, &argsLen, sizeof(argsLen));
+        std::memcpy(bytes.data() + 6, &frameCount, sizeof(frameCount));
+        std::memcpy(bytes.data() + 8, &managedTid, sizeof(managedTid));
+    }
+
+    // What the managed side sends in LightweightMode: the header alone.
+    Payload LightweightPayload() {
+        Payload payload{"lightweight", std::vector<uint8_t>(CallbackIngest::kHeaderSize)};
+        WriteHeader(payload.bytes, g_MethodIds[0], 0, 0);
+        return payload;
+    }
+
+    // Largest record the managed side can send: a full argument block of Int values and a 64 frame stack.
+    Payload FullPayload() {
+        constexpr size_t kArgSize = 1 + sizeof(int64_t);
+        constexpr size_t kArgs = CallbackTraceRecord::kMaxArgBytes / kArgSize;
+        constexpr size_t argsLen = kArgs * kArgSize;
+        constexpr size_t frameCount = CallbackTraceRecord::kMaxFrames;
+
+        Payload payload{"full", std::vector<uint8_t>(CallbackIngest::kHeaderSize + argsLen +
+                                                     frameCount * sizeof(CallbackFrame))};
+        WriteHeader(payload.bytes, g_MethodIds[0], argsLen, frameCount);
+
+        uint8_t *args = payload.bytes.data() + CallbackIngest::kHeaderSize;
+        for (size_t i = 0; i < kArgs; ++i) {
+            const int64_t value = static_cast<int64_t>(i) * 1000;
+            args[i * kArgSize] = static_cast<uint8_t>(ArgTag::Int);
+            std::memcpy(args + i * kArgSize + 1, &value, sizeof(value));
+        }
+
+        uint8_t *frames = args + argsLen;
+        for (size_t i = 0; i < frameCount; ++i) {
+            const CallbackFrame frame{g_MethodIds[i % kMethods], static_cast<int32_t>(i * 4)};
+            std::memcpy(frames + i * sizeof(CallbackFrame), &frame, sizeof(frame));
+        }
+        return payload;
+    }
+
+    void Producer(const Payload &source, size_t ops, std::atomic<int> &ready, const std::atomic<bool> &go,
+                  uint64_t *latencies, uint64_t &cpuNs) {
+        // Every thread cycles through the method ids, so the per-method counters see realistic spread.
+        std::vector<uint8_t> bytes = source.bytes;
+        const auto run = [&](size_t i) {
+            std::memcpy(bytes.data(), &g_MethodIds[i % kMethods], sizeof(uint32_t));
+            CallbackIngest::Enter(bytes.data(), bytes.size());
+            CallbackIngest::Exit();
+        };
+
+        for (size_t i = 0; i < kWarmupOps; ++i)
+            run(i);
+
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        const uint64_t start = ThreadCpuNs();
+        for (size_t i = 0; i < ops; ++i) {
+            const uint64_t opStart = MonotonicNs();
+            run(i);
+            latencies[i] = MonotonicNs() - opStart;
+        }
+        cpuNs = ThreadCpuNs() - start;
+    }
+
+    Result Run(const Payload &payload, int threads, size_t ops) {
+        std::vector<uint64_t> latencies(static_cast<size_t>(threads) * ops);
+        std::vector<uint64_t> cpuNs(static_cast<size_t>(threads));
+        std::vector<std::thread> workers;
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back(Producer, std::cref(payload), ops, std::ref(ready), std::cref(go),
+                                 latencies.data() + static_cast<size_t>(t) * ops, std::ref(cpuNs[t]));
+
+        while (ready.load() != threads)
+            std::this_thread::yield();
+
+        const uint64_t allocationsBefore = g_Allocations.load();
+        const uint64_t start = MonotonicNs();
+        go.store(true, std::memory_order_release);
+        for (std::thread &worker: workers)
+            worker.join();
+        const uint64_t wallNs = MonotonicNs() - start;
+        const uint64_t allocations = g_Allocations.load() - allocationsBefore;
+
+        Result result{};
+        result.ops = static_cast<uint64_t>(threads) * ops;
+        for (uint64_t ns: cpuNs)
+            result.cpuNs += ns;
+        result.wallNs = wallNs;
+        result.allocations = allocations;
+
+        const auto percentile = [&](double p) {
+            const size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+            std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+            return latencies[index];
+        };
+        result.p50Ns = percentile(0.50);
+        result.p99Ns = percentile(0.99);
+        return result;
+    }
+
+    // Cost of one clock read, roughly what the timing around every op adds to the percentiles and ns/op.
+    uint64_t ClockReadNs() {
+        constexpr int kReads = 1'000'000;
+        const uint64_t start = MonotonicNs();
+        uint64_t sink = 0;
+        for (int i = 0; i < kReads; ++i)
+            sink += MonotonicNs();
+        const uint64_t elapsed = MonotonicNs() - start;
+        return sink ? elapsed / kReads : 0;
+    }
+}
+
+// Counts every heap allocation, the ingestion path is supposed to make none.
+void *operator new(size_t size) {
+    g_Allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+int main(int argc, char **argv) {
+    const size_t ops = argc > 1 ? std::max(std::strtoull(argv[1], nullptr, 10), 1000ull) : 200'000;
+    const size_t capacity = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024;
+
+    for (size_t i = 0; i < kMethods; ++i) {
+        const std::string name = "Bench.Plugin.Callback" + std::to_string(i);
+        g_MethodIds[i] = NameTable::Intern(name.c_str(), name.size());
+    }
+    CallbackTrace::Resize(capacity);
+
+    const Payload payloads[] = {LightweightPayload(), FullPayload()};
+
+    std::printf("%zu ops per thread, ring capacity %zu, %u hardware threads, one clock read costs ~%llu ns\n\n",
+                ops, capacity, std::thread::hardware_concurrency(), static_cast<unsigned long long>(ClockReadNs()));
+    std::printf("%-12s %8s %10s %10s %10s %10s %12s\n", "payload", "threads", "ns/op", "Mops/s", "p50 ns", "p99 ns",
+                "allocs/op");
+
+    for (const Payload &payload: payloads) {
+        for (int threads: kThreadCounts) {
+            const Result result = Run(payload, threads, ops);
+            std::printf("%-12s %8d %10.1f %10.2f %10llu %10llu %12.4f\n", payload.name, threads,
+                        static_cast<double>(result.cpuNs) / static_cast<double>(result.ops),
+                        static_cast<double>(result.ops) * 1e3 / static_cast<double>(result.wallNs),
+                        static_cast<unsigned long long>(result.p50Ns), static_cast<unsigned long long>(result.p99Ns),
+                        static_cast<double>(result.allocations) / static_cast<double>(result.ops));
+        }
+    }
+
+    return 0;
+}
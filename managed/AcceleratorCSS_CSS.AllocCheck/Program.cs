@@ -0,0 +1,95 @@
+﻿//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+// Runs the lightweight trace path the way the Harmony patch does and fails if it allocates. The native exports are
+// replaced by empty unmanaged callbacks, so only the managed side is measured.
+//
+// Usage: dotnet run -c Release --project managed/AcceleratorCSS_CSS.AllocCheck [iterations]
+//
+
+using System.Reflection;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using Tracer = AcceleratorCSS_CSS.AcceleratorCSS_CSS;
+
+namespace AcceleratorCSS_CSS.AllocCheck;
+
+internal static unsafe class Program
+{
+    private const int WarmupIterations = 10_000;
+
+    private static long _payloads;
+    private static long _counts;
+    private static MethodBase _method = null!;
+
+    [UnmanagedCallersOnly(CallConvs = [typeof(CallConvCdecl)])]
+    private static void NativeBinary(byte* data, nint length)
+    {
+        _payloads++;
+    }
+
+    [UnmanagedCallersOnly(CallConvs = [typeof(CallConvCdecl)])]
+    private static void NativeExit()
+    {
+    }
+
+    [UnmanagedCallersOnly(CallConvs = [typeof(CallConvCdecl)])]
+    private static void NativeCount(uint id)
+    {
+        _counts++;
+    }
+
+    private static int Main(string[] args)
+    {
+        var iterations = args.Length > 0 ? int.Parse(args[0]) : 1_000_000;
+
+        _method = typeof(Program).GetMethod(nameof(Main), BindingFlags.Static | BindingFlags.NonPublic)!;
+        Tracer.MethodInfos[_method] = new Tracer.MethodTraceInfo { Id = 1, Filtered = false, Plugin = -1 };
+        Tracer.NativeBinary = &NativeBinary;
+        Tracer.NativeExit = &NativeExit;
+        Tracer.NativeCount = &NativeCount;
+
+        var ok = Check("SendLightweight", iterations, static () => Tracer.SendLightweight(1));
+        ok &= Check("TracePrefixLightweight", iterations, TracePrefix);
+
+        // Same path with the native governor attached, once per level the lightweight prefix can see.
+        var control = (Tracer.TraceControl*)NativeMemory.AllocZeroed((nuint)sizeof(Tracer.TraceControl));
+        control->SampleEvery = 16;
+        Tracer.Control = control;
+        foreach (var level in new[] { Tracer.TraceLevel.Lightweight, Tracer.TraceLevel.Sampling })
+        {
+            control->Level = (int)level;
+            ok &= Check($"TracePrefixLightweight ({level})", iterations, TracePrefix);
+        }
+
+        Tracer.Control = null;
+        NativeMemory.Free(control);
+
+        Console.WriteLine(ok ? "OK" : "FAILED: the trace path allocates");
+        return ok ? 0 : 1;
+    }
+
+    private static void TracePrefix()
+    {
+        Tracer.TracePrefixLightweight(_method, out var state);
+        Tracer.TraceFinalizer(state);
+    }
+
+    private static bool Check(string name, int iterations, Action op)
+    {
+        for (var i = 0; i < WarmupIterations; i++)
+            op();
+
+        var payloads = _payloads;
+        var counts = _counts;
+        var before = GC.GetAllocatedBytesForCurrentThread();
+        for (var i = 0; i < iterations; i++)
+            op();
+        var allocated = GC.GetAllocatedBytesForCurrentThread() - before;
+
+        Console.WriteLine($"{name,-36} {(double)allocated / iterations,8:F4} B/op {_payloads - payloads,10} payloads " +
+                          $"{_counts - counts,10} counted only");
+        return allocated == 0;
+    }
+}
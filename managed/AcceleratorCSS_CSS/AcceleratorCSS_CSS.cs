@@ -3,13 +3,19 @@
 // Copyright (c) 2025 slynxcz. All rights reserved.
 //
 
+using System.Buffers.Binary;
+using System.Collections.Concurrent;
 using System.Diagnostics;
+using System.Diagnostics.Tracing;
 using System.Reflection;
+using System.Runtime.ExceptionServices;
 using System.Runtime.InteropServices;
 using System.Runtime.Loader;
 using System.Text;
+using System.Text.Unicode;
 using CounterStrikeSharp.API;
 using CounterStrikeSharp.API.Core;
+using CounterStrikeSharp.API.Modules.Utils;
 using HarmonyLib;
 
 // ReSharper disable InconsistentNaming
@@ -21,9 +27,141 @@ public class AcceleratorCSS_CSS : BasePlugin
     public override string ModuleVersion => "1.0.3";
     private Harmony? _harmony;
     public static bool Lightweight;
-    private static RegisterCallbackTraceBinary? NativeBinary;
+    internal static unsafe delegate* unmanaged[Cdecl]<byte*, nint, void> NativeBinary;
+    private static unsafe delegate* unmanaged[Cdecl]<byte*, nint, byte, uint> NativeRegisterMethod;
+    internal static unsafe delegate* unmanaged[Cdecl]<void> NativeExit;
+    internal static unsafe delegate* unmanaged[Cdecl]<uint, void> NativeCount;
+    private static unsafe delegate* unmanaged[Cdecl]<byte*, nint, uint> NativeRegisterName;
+    private static unsafe delegate* unmanaged[Cdecl]<uint, uint, int, int, void> NativeException;
+    private static unsafe delegate* unmanaged[Cdecl]<GcSnapshot*, void> NativePublishGc;
+    private static unsafe delegate* unmanaged[Cdecl]<uint*, ulong*, int, void> NativePublishAllocations;
+    internal static unsafe TraceControl* Control;
     private static string[] FilterList = [];
 
+    private const int MaxNameChars = 512;
+    private const int MaxArgBytes = 512;
+    private const int MaxArgStringBytes = 64;
+    private const int MaxFrames = 64;
+    private const int FrameSize = 8;
+    private const int HeaderSize = 12;
+    private const uint InvalidMethodId = uint.MaxValue;
+    private const int MaxPlugins = 128;
+
+    private static readonly int MaxPayloadSize =
+        HeaderSize + MaxArgBytes + MaxFrames * FrameSize;
+
+    private static readonly double NsPerTimestamp = 1e9 / Stopwatch.Frequency;
+
+    // Per-method data computed once at patch time, so the prefix never has to build the name or run filters.
+    internal static readonly ConcurrentDictionary<MethodBase, MethodTraceInfo> MethodInfos = new();
+
+    // Names of argument and exception types and of throwing or stack frame methods that are not patched, interned
+    // natively on first sight.
+    private static readonly ConcurrentDictionary<Type, uint> TypeNameIds = new();
+    private static readonly ConcurrentDictionary<MethodBase, uint> MethodNameIds = new();
+
+    // Bytes allocated by the outermost callback of each plugin assembly, indexed by MethodTraceInfo.Plugin.
+    private static readonly ConcurrentDictionary<Assembly, int> PluginIndexes = new();
+    private static readonly uint[] PluginNameIds = new uint[MaxPlugins];
+    private static readonly long[] PluginAllocatedBytes = new long[MaxPlugins];
+    private static int _pluginCount;
+
+    private static GcEventListener? _gcListener;
+    private static int _lastCollectionCount = -1;
+    private static long _lastHeapSizeBytes;
+    private static long _lastFragmentedBytes;
+    private static long _lastAllocationPublish;
+
+    [ThreadStatic] private static byte[]? _sendBuffer;
+    [ThreadStatic] private static bool _inExceptionHandler;
+    [ThreadStatic] private static int _callbackDepth;
+    [ThreadStatic] private static int _outerPlugin;
+    [ThreadStatic] private static long _outerAllocationStart;
+    [ThreadStatic] private static uint _sampleCounter;
+
+    internal sealed class MethodTraceInfo
+    {
+        public required uint Id;
+        public required bool Filtered;
+        public required int Plugin;
+    }
+
+    // Must match acceleratorcss::GcSnapshot.
+    [StructLayout(LayoutKind.Sequential)]
+    private struct GcSnapshot
+    {
+        public long AllocatedBytes;
+        public long HeapSizeBytes;
+        public long FragmentedBytes;
+        public long TotalPauseNs;
+        public long LastPauseNs;
+        public int Gen0Collections;
+        public int Gen1Collections;
+        public int Gen2Collections;
+        public int LastPauseGeneration;
+    }
+
+    // Mirrors acceleratorcss::TraceLevel.
+    internal enum TraceLevel
+    {
+        Full,
+        Lightweight,
+        Sampling
+    }
+
+    // Must match acceleratorcss::TraceControl. The native governor picks the level from the time added here.
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct TraceControl
+    {
+        public int Level;
+        public int SampleEvery;
+        public long ManagedNs;
+    }
+
+    // Measures individual GC pauses from the runtime's suspend/restart events, GC.GetTotalPauseDuration only has
+    // the running total.
+    private sealed class GcEventListener : EventListener
+    {
+        private const int GCStartEventId = 1;
+        private const int GCRestartEEEndEventId = 3;
+        private const int GCSuspendEEBeginEventId = 9;
+        private const long GCKeyword = 0x1;
+
+        private long _suspendTicks;
+        private int _generation;
+
+        public long LastPauseNs;
+        public int LastPauseGeneration;
+
+        protected override void OnEventSourceCreated(EventSource source)
+        {
+            if (source.Name == "Microsoft-Windows-DotNETRuntime")
+                EnableEvents(source, EventLevel.Informational, (EventKeywords)GCKeyword);
+        }
+
+        protected override void OnEventWritten(EventWrittenEventArgs e)
+        {
+            switch (e.EventId)
+            {
+                case GCStartEventId:
+                    var depth = e.PayloadNames?.IndexOf("Depth") ?? -1;
+                    if (depth >= 0 && e.Payload?[depth] is uint generation)
+                        _generation = (int)generation;
+                    break;
+                case GCSuspendEEBeginEventId:
+                    _suspendTicks = e.TimeStamp.Ticks;
+                    break;
+                case GCRestartEEEndEventId:
+                    if (_suspendTicks == 0)
+                        break;
+                    LastPauseGeneration = _generation;
+                    Volatile.Write(ref LastPauseNs, (e.TimeStamp.Ticks - _suspendTicks) * 100);
+                    _suspendTicks = 0;
+                    break;
+            }
+        }
+    }
+
     [StructLayout(LayoutKind.Sequential)]
     public struct PluginConfig
     {
@@ -35,11 +173,16 @@ public class AcceleratorCSS_CSS : BasePlugin
     public override void Load(bool hotReload)
     {
         RegisterListener<Listeners.OnMetamodAllPluginsLoaded>(OnMetamodAllPluginsLoaded);
+        RegisterListener<Listeners.OnTick>(OnTick);
     }
 
     public override void Unload(bool hotReload)
     {
         RemoveListener<Listeners.OnMetamodAllPluginsLoaded>(OnMetamodAllPluginsLoaded);
+        RemoveListener<Listeners.OnTick>(OnTick);
+        AppDomain.CurrentDomain.FirstChanceException -= OnFirstChanceException;
+        _gcListener?.Dispose();
+        _gcListener = null;
         _harmony?.UnpatchAll("AcceleratorCSS_CSS");
     }
 
@@ -59,7 +202,28 @@ public class AcceleratorCSS_CSS : BasePlugin
             var handle = NativeLibrary.Load(path);
 
             var fnPtr = NativeLibrary.GetExport(handle, "RegisterCallbackTraceBinary");
-            NativeBinary = Marshal.GetDelegateForFunctionPointer<RegisterCallbackTraceBinary>(fnPtr);
+            var registerPtr = NativeLibrary.GetExport(handle, "RegisterCallbackMethod");
+            var exitPtr = NativeLibrary.GetExport(handle, "RegisterCallbackExit");
+            var namePtr = NativeLibrary.GetExport(handle, "RegisterName");
+            var exceptionPtr = NativeLibrary.GetExport(handle, "RegisterFirstChanceException");
+            var gcPtr = NativeLibrary.GetExport(handle, "PublishGcSnapshot");
+            var allocationsPtr = NativeLibrary.GetExport(handle, "PublishPluginAllocations");
+            unsafe
+            {
+                NativeBinary = (delegate* unmanaged[Cdecl]<byte*, nint, void>)fnPtr;
+                NativeRegisterMethod = (delegate* unmanaged[Cdecl]<byte*, nint, byte, uint>)registerPtr;
+                NativeExit = (delegate* unmanaged[Cdecl]<void>)exitPtr;
+                NativeRegisterName = (delegate* unmanaged[Cdecl]<byte*, nint, uint>)namePtr;
+                NativeException = (delegate* unmanaged[Cdecl]<uint, uint, int, int, void>)exceptionPtr;
+                NativePublishGc = (delegate* unmanaged[Cdecl]<GcSnapshot*, void>)gcPtr;
+                NativePublishAllocations = (delegate* unmanaged[Cdecl]<uint*, ulong*, int, void>)allocationsPtr;
+
+                // Older native builds have no governor, tracing then simply stays at the configured level.
+                if (NativeLibrary.TryGetExport(handle, "GetTraceControl", out var controlPtr))
+                    Control = ((delegate* unmanaged[Cdecl]<TraceControl*>)controlPtr)();
+                if (NativeLibrary.TryGetExport(handle, "RegisterCallbackCount", out var countPtr))
+                    NativeCount = (delegate* unmanaged[Cdecl]<uint, void>)countPtr;
+            }
 
             var initPtr = NativeLibrary.GetExport(handle, "CssPluginRegistered");
             var initFn = Marshal.GetDelegateForFunctionPointer<CssPluginRegisteredDelegate>(initPtr);
@@ -82,6 +246,9 @@ public class AcceleratorCSS_CSS : BasePlugin
                 }
             }
 
+            AppDomain.CurrentDomain.FirstChanceException += OnFirstChanceException;
+            _gcListener = new GcEventListener();
+
             Prints.ServerLog("[AcceleratorCSS_CSS] Native library successfully loaded.", ConsoleColor.Green);
         }
         catch (Exception ex)
@@ -97,6 +264,13 @@ public class AcceleratorCSS_CSS : BasePlugin
     {
         _harmony = new Harmony("AcceleratorCSS_CSS");
 
+        // Lightweight mode must not ask Harmony for __args, it boxes every argument into a fresh array per call.
+        var prefix = new HarmonyMethod(typeof(AcceleratorCSS_CSS).GetMethod(
+            Lightweight ? nameof(TracePrefixLightweight) : nameof(TracePrefix),
+            BindingFlags.Static | BindingFlags.NonPublic));
+        var finalizer = new HarmonyMethod(typeof(AcceleratorCSS_CSS).GetMethod(
+            nameof(TraceFinalizer), BindingFlags.Static | BindingFlags.NonPublic));
+
         int totalAssemblies = 0;
         int totalTypes = 0;
         int totalMethods = 0;
@@ -179,11 +353,15 @@ public class AcceleratorCSS_CSS : BasePlugin
                         totalMethods++;
                         try
                         {
-                            var prefix = new HarmonyMethod(typeof(AcceleratorCSS_CSS).GetMethod(
-                                nameof(TracePrefix),
-                                BindingFlags.Static | BindingFlags.NonPublic));
-
-                            _harmony.Patch(method, prefix: prefix);
+                            var info = CreateTraceInfo(method);
+                            if (info == null)
+                            {
+                                skippedMethods++;
+                                continue;
+                            }
+
+                            MethodInfos[method] = info;
+                            _harmony.Patch(method, prefix: prefix, finalizer: finalizer);
                             patchedMethods++;
                         }
                         catch (Exception ex)
@@ -208,63 +386,519 @@ public class AcceleratorCSS_CSS : BasePlugin
 
     private static bool ShouldFilter(string name)
     {
-        return FilterList.Any(filter => name.Contains(filter, StringComparison.OrdinalIgnoreCase));
+        foreach (var filter in FilterList)
+        {
+            if (name.Contains(filter, StringComparison.OrdinalIgnoreCase))
+                return true;
+        }
+
+        return false;
     }
 
-    private static bool TracePrefix(MethodBase __originalMethod, object __instance, object[]? __args)
+    private static unsafe MethodTraceInfo? CreateTraceInfo(MethodBase method)
     {
+        var name = Trim($"{method.DeclaringType?.FullName}::{method.Name}", MaxNameChars);
+        var nameBytes = Encoding.UTF8.GetBytes(name);
+        var filtered = ShouldFilter(name);
+
+        uint id;
+        fixed (byte* namePtr = nameBytes)
+        {
+            id = NativeRegisterMethod(namePtr, nameBytes.Length, filtered ? (byte)1 : (byte)0);
+        }
+
+        if (id == InvalidMethodId)
+            return null;
+
+        return new MethodTraceInfo
+        {
+            Id = id,
+            Filtered = filtered,
+            Plugin = PluginIndex(method.DeclaringType?.Assembly)
+        };
+    }
+
+    internal static bool TracePrefixLightweight(MethodBase __originalMethod, out bool __state)
+    {
+        __state = false;
+        var start = Stopwatch.GetTimestamp();
         try
         {
-            var name = Trim($"{__originalMethod.DeclaringType?.FullName}::{__originalMethod?.Name}", 512);
+            if (MethodInfos.TryGetValue(__originalMethod, out var info))
+            {
+                if (SkipSample(CurrentLevel()))
+                {
+                    CountOnly(info.Id);
+                }
+                else
+                {
+                    __state = SendLightweight(info.Id);
+                    if (__state)
+                        EnterAllocationScope(info.Plugin);
+                }
+            }
+        }
+        catch
+        {
+            // ignored
+        }
+        finally
+        {
+            AddOverhead(start);
+        }
+
+        return true;
+    }
 
-            if (ShouldFilter(name))
+    private static bool TracePrefix(MethodBase __originalMethod, object __instance, object[]? __args,
+        out bool __state)
+    {
+        __state = false;
+        var start = Stopwatch.GetTimestamp();
+        try
+        {
+            if (!MethodInfos.TryGetValue(__originalMethod, out var info))
                 return true;
 
-            string profile = Lightweight ? "LW" : Trim(string.Join(", ", __args?.Select(SafeToString) ?? []), 2048);
-            string stack = Lightweight ? "LW" : Trim(new StackTrace(2, true).ToString(), 4096);
-            SendBinary(name, profile, stack);
+            var level = CurrentLevel();
+            if (SkipSample(level))
+            {
+                CountOnly(info.Id);
+                return true;
+            }
+
+            // Filtered methods are still counted natively, they just never carry arguments or a stack. Harmony has
+            // already boxed __args by now, degrading only saves the argument encoding and the stack walk.
+            if (info.Filtered || level != TraceLevel.Full)
+            {
+                __state = SendLightweight(info.Id);
+            }
+            else
+            {
+                // Without file info the runtime skips the PDB lookup, frames are kept as name ids and only turned
+                // into text natively when a report is written.
+                __state = SendFull(info.Id, __args, new StackTrace(2, false));
+            }
+
+            // Started after the trace payload is built, so the tracer's own allocations are not billed to the plugin.
+            if (__state)
+                EnterAllocationScope(info.Plugin);
         }
         catch
         {
             // ignored
         }
+        finally
+        {
+            AddOverhead(start);
+        }
 
         return true;
     }
 
-    private static void SendBinary(string name, string profile, string stack)
+    // Runs even when the original throws, so the native callback stack stays balanced.
+    internal static unsafe void TraceFinalizer(bool __state)
     {
-        if (NativeBinary == null)
-        {
-            Prints.ServerLog("[AcceleratorCSS_CSS] SendBinary skipped (NativeBinary == null)", ConsoleColor.Red);
+        if (!__state)
             return;
+
+        var start = Stopwatch.GetTimestamp();
+        ExitAllocationScope();
+        if (NativeExit != null)
+            NativeExit();
+        AddOverhead(start);
+    }
+
+    private static unsafe TraceLevel CurrentLevel()
+    {
+        var control = Control;
+        return control != null ? (TraceLevel)Volatile.Read(ref control->Level) : TraceLevel.Full;
+    }
+
+    // In sampling mode only every n-th callback per thread is traced, the skipped ones are only counted.
+    private static unsafe bool SkipSample(TraceLevel level)
+    {
+        if (level != TraceLevel.Sampling)
+            return false;
+
+        var every = (uint)Math.Max(Control->SampleEvery, 1);
+        return ++_sampleCounter % every != 0;
+    }
+
+    // Keeps the native per-method counters exact while sampling, the call stack and the trace ring miss the callback.
+    private static unsafe void CountOnly(uint id)
+    {
+        if (NativeCount != null)
+            NativeCount(id);
+    }
+
+    private static unsafe void AddOverhead(long start)
+    {
+        var control = Control;
+        if (control != null)
+            Interlocked.Add(ref control->ManagedNs, (long)((Stopwatch.GetTimestamp() - start) * NsPerTimestamp));
+    }
+
+    // Only the outermost callback on a thread is measured, nested callbacks are already inside its window.
+    private static void EnterAllocationScope(int plugin)
+    {
+        if (_callbackDepth++ != 0)
+            return;
+
+        _outerPlugin = plugin;
+        _outerAllocationStart = GC.GetAllocatedBytesForCurrentThread();
+    }
+
+    private static void ExitAllocationScope()
+    {
+        if (_callbackDepth == 0 || --_callbackDepth != 0 || _outerPlugin < 0)
+            return;
+
+        Interlocked.Add(ref PluginAllocatedBytes[_outerPlugin],
+            GC.GetAllocatedBytesForCurrentThread() - _outerAllocationStart);
+    }
+
+    private static int PluginIndex(Assembly? assembly)
+    {
+        if (assembly == null)
+            return -1;
+        if (PluginIndexes.TryGetValue(assembly, out var index))
+            return index;
+        if (_pluginCount == MaxPlugins)
+            return -1;
+
+        var nameId = RegisterName(assembly.GetName().Name ?? assembly.FullName ?? "[unknown]");
+        if (nameId == InvalidMethodId)
+            return -1;
+
+        index = _pluginCount++;
+        PluginNameIds[index] = nameId;
+        PluginIndexes[assembly] = index;
+        return index;
+    }
+
+    private static unsafe void OnTick()
+    {
+        if (NativePublishGc == null)
+            return;
+
+        // GetGCMemoryInfo allocates, so it is only refreshed after a collection happened.
+        var collections = GC.CollectionCount(0);
+        if (collections != _lastCollectionCount)
+        {
+            _lastCollectionCount = collections;
+            var info = GC.GetGCMemoryInfo();
+            _lastHeapSizeBytes = info.HeapSizeBytes;
+            _lastFragmentedBytes = info.FragmentedBytes;
         }
 
-        var nameBytes = Encoding.UTF8.GetBytes(name);
-        var profileBytes = Encoding.UTF8.GetBytes(profile);
-        var stackBytes = Encoding.UTF8.GetBytes(stack);
+        var snapshot = new GcSnapshot
+        {
+            AllocatedBytes = GC.GetTotalAllocatedBytes(),
+            HeapSizeBytes = _lastHeapSizeBytes,
+            FragmentedBytes = _lastFragmentedBytes,
+            TotalPauseNs = GC.GetTotalPauseDuration().Ticks * 100,
+            LastPauseNs = _gcListener != null ? Volatile.Read(ref _gcListener.LastPauseNs) : 0,
+            Gen0Collections = collections,
+            Gen1Collections = GC.CollectionCount(1),
+            Gen2Collections = GC.CollectionCount(2),
+            LastPauseGeneration = _gcListener?.LastPauseGeneration ?? 0
+        };
+        NativePublishGc(&snapshot);
+
+        var now = Stopwatch.GetTimestamp();
+        if (NativePublishAllocations == null || now - _lastAllocationPublish < Stopwatch.Frequency)
+            return;
+        _lastAllocationPublish = now;
 
-        var buffer = new byte[6 + nameBytes.Length + profileBytes.Length + stackBytes.Length];
-        BitConverter.GetBytes((ushort)nameBytes.Length).CopyTo(buffer, 0);
-        BitConverter.GetBytes((ushort)profileBytes.Length).CopyTo(buffer, 2);
-        BitConverter.GetBytes((ushort)stackBytes.Length).CopyTo(buffer, 4);
-        Buffer.BlockCopy(nameBytes, 0, buffer, 6, nameBytes.Length);
-        Buffer.BlockCopy(profileBytes, 0, buffer, 6 + nameBytes.Length, profileBytes.Length);
-        Buffer.BlockCopy(stackBytes, 0, buffer, 6 + nameBytes.Length + profileBytes.Length, stackBytes.Length);
+        var count = _pluginCount;
+        var bytes = stackalloc ulong[count];
+        for (var i = 0; i < count; i++)
+            bytes[i] = (ulong)Interlocked.Read(ref PluginAllocatedBytes[i]);
 
-        NativeBinary(buffer, buffer.Length);
+        fixed (uint* ids = PluginNameIds)
+        {
+            NativePublishAllocations(ids, bytes, count);
+        }
     }
 
-    private static string SafeToString(object? obj)
+    // Reports every thrown exception, including the ones plugins swallow. The native side does the rate limiting.
+    private static unsafe void OnFirstChanceException(object? sender, FirstChanceExceptionEventArgs e)
     {
+        // Anything thrown in here would raise the event again on the same thread.
+        if (_inExceptionHandler || NativeException == null)
+            return;
+
+        _inExceptionHandler = true;
         try
         {
-            return obj?.ToString() ?? "null";
+            var exception = e.Exception;
+            var typeId = TypeNameId(exception.GetType());
+
+            var methodId = InvalidMethodId;
+            var site = exception.TargetSite;
+            if (site != null)
+                methodId = MethodNameId(site);
+
+            NativeException(typeId, methodId, exception.HResult, Environment.CurrentManagedThreadId);
         }
         catch
         {
-            return "[error]";
+            // ignored
+        }
+        finally
+        {
+            _inExceptionHandler = false;
+        }
+    }
+
+    private static uint TypeNameId(Type type)
+    {
+        return TypeNameIds.GetOrAdd(type, t => RegisterName(t.FullName ?? t.Name));
+    }
+
+    private static uint MethodNameId(MethodBase method)
+    {
+        return MethodInfos.TryGetValue(method, out var info)
+            ? info.Id
+            : MethodNameIds.GetOrAdd(method, m => RegisterName($"{m.DeclaringType?.FullName}::{m.Name}"));
+    }
+
+    // Patched methods run as Harmony replacements, map those frames back to the method the plugin wrote.
+    private static uint FrameMethodId(StackFrame frame)
+    {
+        var method = frame.GetMethod();
+        if (method != null && MethodNameIds.TryGetValue(method, out var id))
+            return id;
+
+        var original = Harmony.GetOriginalMethodFromStackframe(frame) ?? method;
+        if (original == null)
+            return InvalidMethodId;
+
+        id = MethodNameId(original);
+        if (method != null)
+            MethodNameIds.TryAdd(method, id);
+        return id;
+    }
+
+    private static unsafe uint RegisterName(string name)
+    {
+        var bytes = Encoding.UTF8.GetBytes(Trim(name, MaxNameChars));
+        fixed (byte* ptr = bytes)
+        {
+            return NativeRegisterName(ptr, bytes.Length);
+        }
+    }
+
+    internal static bool SendLightweight(uint id)
+    {
+        Span<byte> header = stackalloc byte[HeaderSize];
+        WriteHeader(header, id, 0, 0);
+        return Send(header);
+    }
+
+    // Payload is the header, the tagged arguments (acceleratorcss::ArgTag) and then frameCount frames of
+    // (uint method id, int IL offset).
+    private static bool SendFull(uint id, object?[]? args, StackTrace stack)
+    {
+        var buffer = _sendBuffer ??= GC.AllocateUninitializedArray<byte>(MaxPayloadSize, pinned: true);
+
+        var body = buffer.AsSpan(HeaderSize);
+        int argsLen = WriteArgs(body[..MaxArgBytes], args);
+
+        var frames = body[argsLen..];
+        var frameCount = 0;
+        for (var i = 0; i < stack.FrameCount && frameCount < MaxFrames; i++)
+        {
+            var frame = stack.GetFrame(i);
+            if (frame == null)
+                continue;
+
+            var frameSpan = frames[(frameCount++ * FrameSize)..];
+            BinaryPrimitives.WriteUInt32LittleEndian(frameSpan, FrameMethodId(frame));
+            BinaryPrimitives.WriteInt32LittleEndian(frameSpan[4..], frame.GetILOffset());
+        }
+
+        WriteHeader(buffer, id, argsLen, frameCount);
+        return Send(buffer.AsSpan(0, HeaderSize + argsLen + frameCount * FrameSize));
+    }
+
+    // Mirrors acceleratorcss::ArgTag. Only reads the boxed values, never calls into plugin code such as ToString().
+    private enum ArgTag : byte
+    {
+        Null,
+        Bool,
+        Int,
+        UInt,
+        Float,
+        String,
+        Entity,
+        Enum,
+        Object,
+        Truncated
+    }
+
+    // Largest fixed size argument: tag, type id and an 8 byte value.
+    private const int MaxArgSize = 13;
+
+    private static int WriteArgs(Span<byte> buffer, object?[]? args)
+    {
+        if (args == null)
+            return 0;
+
+        var written = 0;
+        foreach (var arg in args)
+        {
+            // Keeps room for the truncation marker after the largest fixed size argument.
+            if (buffer.Length - written < MaxArgSize + 1)
+            {
+                buffer[written++] = (byte)ArgTag.Truncated;
+                break;
+            }
+
+            var slot = buffer[written..(buffer.Length - 1)];
+            try
+            {
+                written += WriteArg(slot, arg);
+            }
+            catch
+            {
+                // Entity wrappers can throw once the entity is gone, keep the type so the position is not lost.
+                written += WriteTyped(slot, ArgTag.Object, arg!.GetType());
+            }
         }
+
+        return written;
+    }
+
+    private static int WriteArg(Span<byte> buffer, object? arg)
+    {
+        switch (arg)
+        {
+            case null:
+                buffer[0] = (byte)ArgTag.Null;
+                return 1;
+            case bool value:
+                buffer[0] = (byte)ArgTag.Bool;
+                buffer[1] = value ? (byte)1 : (byte)0;
+                return 2;
+            case string value:
+            {
+                buffer[0] = (byte)ArgTag.String;
+                var room = Math.Min(MaxArgStringBytes, buffer.Length - 2);
+                // Stops at a whole character when the string does not fit.
+                Utf8.FromUtf16(value, buffer.Slice(2, room), out _, out var length, isFinalBlock: false);
+                buffer[1] = (byte)length;
+                return 2 + length;
+            }
+            case NativeEntity entity:
+                return WriteTyped(buffer, ArgTag.Entity, entity.GetType(), entity.EntityHandle?.Raw ?? uint.MaxValue);
+            case CEntityHandle handle:
+                return WriteTyped(buffer, ArgTag.Entity, typeof(CEntityHandle), handle.Raw);
+            case Enum value:
+                buffer[0] = (byte)ArgTag.Enum;
+                BinaryPrimitives.WriteUInt32LittleEndian(buffer[1..], TypeNameId(value.GetType()));
+                BinaryPrimitives.WriteInt64LittleEndian(buffer[5..], EnumValue(value));
+                return 13;
+        }
+
+        switch (Type.GetTypeCode(arg.GetType()))
+        {
+            case TypeCode.SByte:
+                return WriteInt(buffer, (sbyte)arg);
+            case TypeCode.Int16:
+                return WriteInt(buffer, (short)arg);
+            case TypeCode.Int32:
+                return WriteInt(buffer, (int)arg);
+            case TypeCode.Int64:
+                return WriteInt(buffer, (long)arg);
+            case TypeCode.Char:
+                return WriteInt(buffer, (char)arg);
+            case TypeCode.Byte:
+                return WriteUInt(buffer, (byte)arg);
+            case TypeCode.UInt16:
+                return WriteUInt(buffer, (ushort)arg);
+            case TypeCode.UInt32:
+                return WriteUInt(buffer, (uint)arg);
+            case TypeCode.UInt64:
+                return WriteUInt(buffer, (ulong)arg);
+            case TypeCode.Single:
+                return WriteFloat(buffer, (float)arg);
+            case TypeCode.Double:
+                return WriteFloat(buffer, (double)arg);
+            case TypeCode.Decimal:
+                return WriteFloat(buffer, (double)(decimal)arg);
+        }
+
+        return arg switch
+        {
+            nint value => WriteInt(buffer, value),
+            nuint value => WriteUInt(buffer, value),
+            _ => WriteTyped(buffer, ArgTag.Object, arg.GetType())
+        };
+    }
+
+    private static int WriteInt(Span<byte> buffer, long value)
+    {
+        buffer[0] = (byte)ArgTag.Int;
+        BinaryPrimitives.WriteInt64LittleEndian(buffer[1..], value);
+        return 9;
+    }
+
+    private static int WriteUInt(Span<byte> buffer, ulong value)
+    {
+        buffer[0] = (byte)ArgTag.UInt;
+        BinaryPrimitives.WriteUInt64LittleEndian(buffer[1..], value);
+        return 9;
+    }
+
+    private static int WriteFloat(Span<byte> buffer, double value)
+    {
+        buffer[0] = (byte)ArgTag.Float;
+        BinaryPrimitives.WriteDoubleLittleEndian(buffer[1..], value);
+        return 9;
+    }
+
+    private static int WriteTyped(Span<byte> buffer, ArgTag tag, Type type)
+    {
+        buffer[0] = (byte)tag;
+        BinaryPrimitives.WriteUInt32LittleEndian(buffer[1..], TypeNameId(type));
+        return 5;
+    }
+
+    private static int WriteTyped(Span<byte> buffer, ArgTag tag, Type type, uint value)
+    {
+        WriteTyped(buffer, tag, type);
+        BinaryPrimitives.WriteUInt32LittleEndian(buffer[5..], value);
+        return 9;
+    }
+
+    private static long EnumValue(Enum value)
+    {
+        return Type.GetTypeCode(value.GetType()) == TypeCode.UInt64
+            ? unchecked((long)Convert.ToUInt64(value))
+            : Convert.ToInt64(value);
+    }
+
+    private static void WriteHeader(Span<byte> buffer, uint id, int argsLen, int frameCount)
+    {
+        BinaryPrimitives.WriteUInt32LittleEndian(buffer, id);
+        BinaryPrimitives.WriteUInt16LittleEndian(buffer[4..], (ushort)argsLen);
+        BinaryPrimitives.WriteUInt16LittleEndian(buffer[6..], (ushort)frameCount);
+        BinaryPrimitives.WriteInt32LittleEndian(buffer[8..], Environment.CurrentManagedThreadId);
+    }
+
+    private static unsafe bool Send(ReadOnlySpan<byte> payload)
+    {
+        if (NativeBinary == null)
+            return false;
+
+        fixed (byte* data = payload)
+        {
+            NativeBinary(data, payload.Length);
+        }
+
+        return true;
     }
 
     private static string Trim(string str, int max)
@@ -300,9 +934,6 @@ public class AcceleratorCSS_CSS : BasePlugin
     [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
     private delegate PluginConfig CssPluginRegisteredDelegate();
 
-    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-    private delegate void RegisterCallbackTraceBinary(byte[] data, int len);
-
     private static IEnumerable<MethodInfo> GetAllMethods(Type? type)
     {
         const BindingFlags flags = BindingFlags.Public | BindingFlags.NonPublic |
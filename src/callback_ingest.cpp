@@ -0,0 +1,67 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "callback_ingest.h"
+#include "callback_stack.h"
+#include "callback_stats.h"
+#include "callback_trace.h"
+#include "capture.h"
+#include "log.h"
+#include "names.h"
+#include "timing.h"
+#include "trace_governor.h"
+
+#include <cstring>
+
+namespace acceleratorcss {
+    namespace {
+        bool g_LogToConsole = false;
+    }
+
+    void CallbackIngest::SetLogToConsole(bool enabled) {
+        g_LogToConsole = enabled;
+    }
+
+    void CallbackIngest::Enter(const void *data, size_t len) {
+        TraceOverheadScope overhead;
+        if (!data || len < kHeaderSize)
+            return;
+
+        const char *raw = static_cast<const char *>(data);
+        uint32_t methodId;
+        uint16_t argsLen;
+        uint16_t frameCount;
+        int32_t managedTid;
+        std::memcpy(&methodId, raw, sizeof(methodId));
+        std::memcpy(&argsLen, raw + 4, sizeof(argsLen));
+        std::memcpy(&frameCount, raw + 6, sizeof(frameCount));
+        std::memcpy(&managedTid, raw + 8, sizeof(managedTid));
+
+        if (len < kHeaderSize + argsLen + frameCount * sizeof(CallbackFrame))
+            return;
+
+        CallbackStats::Record(methodId);
+        CallbackStack::Enter(methodId, MonotonicNs());
+        if (TraceCapture::IsActive())
+            TraceCapture::Record(TraceCapture::Phase::Enter, methodId);
+        if (CallbackStats::IsFiltered(methodId))
+            return;
+
+        if (g_LogToConsole)
+            ACC_CORE_INFO("[Callback] Name: {}", NameTable::Get(methodId));
+
+        CallbackTrace::Push(methodId, managedTid, raw + kHeaderSize, argsLen, raw + kHeaderSize + argsLen, frameCount);
+    }
+
+    void CallbackIngest::Exit() {
+        TraceOverheadScope overhead;
+        const uint32_t methodId = CallbackStack::Exit();
+        if (TraceCapture::IsActive())
+            TraceCapture::Record(TraceCapture::Phase::Exit, methodId);
+    }
+
+    void CallbackIngest::Count(uint32_t methodId) {
+        CallbackStats::Record(methodId);
+    }
+}
@@ -0,0 +1,30 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    // Entry points the managed Harmony prefix and finalizer call for every traced callback. Kept free of the SDK so
+    // the hot path can be built and benchmarked on its own (bench/trace_ingest_bench.cpp).
+    class CallbackIngest {
+    public:
+        // Size of the record header: u32 method id, u16 args length, u16 frame count, i32 managed thread id.
+        static constexpr size_t kHeaderSize = 12;
+
+        static void SetLogToConsole(bool enabled);
+
+        // Counts the call, pushes it onto the thread's callback stack and stores its arguments and frames in the
+        // trace ring unless the method is filtered.
+        static void Enter(const void *data, size_t len);
+
+        static void Exit();
+
+        // Counts a callback the managed side skipped while sampling, so per-method rates stay exact at every trace
+        // level. Not timed natively, the managed prefix already reports its own time including this call.
+        static void Count(uint32_t methodId);
+    };
+}
@@ -0,0 +1,99 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "callback_stack.h"
+#include "names.h"
+#include "timing.h"
+
+#include <atomic>
+
+namespace acceleratorcss {
+    namespace {
+        struct ThreadSlot {
+            std::atomic<int> tid{0};
+            std::atomic<uint32_t> depth{0};
+            uint32_t methodIds[CallbackStack::kMaxDepth];
+            uint64_t enterNs[CallbackStack::kMaxDepth];
+        };
+
+        ThreadSlot g_Slots[CallbackStack::kMaxThreads];
+
+        // Releases the slot when the thread exits so pool threads that come and go do not exhaust the table.
+        struct SlotOwner {
+            ThreadSlot *slot = nullptr;
+            bool claimed = false;
+
+            ~SlotOwner() {
+                if (!slot)
+                    return;
+                slot->depth.store(0, std::memory_order_relaxed);
+                slot->tid.store(0, std::memory_order_release);
+            }
+        };
+
+        thread_local SlotOwner t_Owner;
+
+        ThreadSlot *CurrentSlot() {
+            if (t_Owner.claimed)
+                return t_Owner.slot;
+            t_Owner.claimed = true;
+
+            const int tid = CurrentThreadId();
+            for (auto &slot: g_Slots) {
+                int expected = 0;
+                if (slot.tid.compare_exchange_strong(expected, tid, std::memory_order_acq_rel)) {
+                    slot.depth.store(0, std::memory_order_relaxed);
+                    t_Owner.slot = &slot;
+                    break;
+                }
+            }
+
+            return t_Owner.slot;
+        }
+    }
+
+    void CallbackStack::Enter(uint32_t methodId, uint64_t enterNs) {
+        ThreadSlot *slot = CurrentSlot();
+        if (!slot)
+            return;
+
+        const uint32_t depth = slot->depth.load(std::memory_order_relaxed);
+        if (depth < kMaxDepth) {
+            slot->methodIds[depth] = methodId;
+            slot->enterNs[depth] = enterNs;
+        }
+        slot->depth.store(depth + 1, std::memory_order_release);
+    }
+
+    uint32_t CallbackStack::Exit() {
+        ThreadSlot *slot = CurrentSlot();
+        if (!slot)
+            return NameTable::kInvalidId;
+
+        const uint32_t depth = slot->depth.load(std::memory_order_relaxed);
+        if (depth == 0)
+            return NameTable::kInvalidId;
+
+        slot->depth.store(depth - 1, std::memory_order_release);
+        return depth <= kMaxDepth ? slot->methodIds[depth - 1] : NameTable::kInvalidId;
+    }
+
+    bool CallbackStack::Oldest(OpenCallback &out) {
+        bool found = false;
+
+        for (auto &slot: g_Slots) {
+            const int tid = slot.tid.load(std::memory_order_acquire);
+            const uint32_t depth = slot.depth.load(std::memory_order_acquire);
+            if (tid == 0 || depth == 0)
+                continue;
+
+            if (!found || slot.enterNs[0] < out.enterNs) {
+                out = {slot.methodIds[0], slot.enterNs[0], tid, depth};
+                found = true;
+            }
+        }
+
+        return found;
+    }
+}
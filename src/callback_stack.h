@@ -0,0 +1,33 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct OpenCallback {
+        uint32_t methodId;
+        uint64_t enterNs;
+        int tid;
+        uint32_t depth;
+    };
+
+    // Shadow stack of the C# callbacks currently executing on each thread. Every thread claims one preallocated
+    // slot on its first callback, so the crash handler can inspect all of them without allocating.
+    class CallbackStack {
+    public:
+        static constexpr size_t kMaxThreads = 256;
+        static constexpr size_t kMaxDepth = 64;
+
+        static void Enter(uint32_t methodId, uint64_t enterNs);
+
+        // Pops the current thread's innermost callback and returns its method id, if it was recorded.
+        static uint32_t Exit();
+
+        // Finds the outermost callback that has been on any thread's stack the longest.
+        static bool Oldest(OpenCallback &out);
+    };
+}
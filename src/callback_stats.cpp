@@ -0,0 +1,170 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "callback_stats.h"
+#include "names.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace acceleratorcss {
+    namespace {
+        // Only the busiest kTopPerSecond methods of each second are kept, which is plenty for a top-N report.
+        struct SecondFrame {
+            uint32_t count;
+            uint32_t methodIds[CallbackStats::kTopPerSecond];
+            uint32_t calls[CallbackStats::kTopPerSecond];
+        };
+
+        constexpr uint32_t kMaxMethods = NameTable::kMaxNames;
+
+        std::atomic<uint64_t> g_Calls[kMaxMethods];
+        std::atomic<bool> g_Filtered[kMaxMethods];
+        uint64_t g_LastCalls[kMaxMethods];
+
+        SecondFrame g_Frames[CallbackStats::kHistorySeconds];
+        uint64_t g_FrameCount = 0;
+        std::chrono::steady_clock::time_point g_LastAdvance;
+        bool g_AdvanceStarted = false;
+
+        CallbackRate g_AdvanceScratch[kMaxMethods];
+        CallbackRate g_TopScratch[kMaxMethods];
+        uint64_t g_TopSums[kMaxMethods];
+        CallbackRate g_CrashScratch[kMaxMethods];
+        uint64_t g_CrashSums[kMaxMethods];
+
+        bool ByCallsDesc(const CallbackRate &a, const CallbackRate &b) { return a.calls > b.calls; }
+
+        void Accumulate(uint32_t id, uint64_t calls, CallbackRate *scratch, uint64_t *sums, size_t &active) {
+            if (sums[id] == 0)
+                scratch[active++] = {id, 0};
+            sums[id] += calls;
+        }
+
+        size_t Collect(uint32_t seconds, bool includeCurrent, CallbackRate *scratch, uint64_t *sums,
+                       CallbackRate *out, size_t max) {
+            size_t active = 0;
+
+            for (uint32_t back = 1; back <= seconds; ++back) {
+                const SecondFrame &frame = g_Frames[(g_FrameCount - back) % CallbackStats::kHistorySeconds];
+                for (uint32_t i = 0; i < frame.count; ++i)
+                    Accumulate(frame.methodIds[i], frame.calls[i], scratch, sums, active);
+            }
+
+            if (includeCurrent) {
+                const uint32_t methodCount = std::min(NameTable::Count(), kMaxMethods);
+                for (uint32_t id = 0; id < methodCount; ++id) {
+                    const uint64_t delta = g_Calls[id].load(std::memory_order_relaxed) - g_LastCalls[id];
+                    if (delta)
+                        Accumulate(id, delta, scratch, sums, active);
+                }
+            }
+
+            for (size_t i = 0; i < active; ++i) {
+                scratch[i].calls = sums[scratch[i].methodId];
+                sums[scratch[i].methodId] = 0;
+            }
+
+            const size_t count = std::min(active, max);
+            std::partial_sort(scratch, scratch + count, scratch + active, ByCallsDesc);
+            std::copy_n(scratch, count, out);
+
+            return count;
+        }
+    }
+
+    void CallbackStats::SetFiltered(uint32_t methodId, bool filtered) {
+        if (methodId < kMaxMethods)
+            g_Filtered[methodId].store(filtered, std::memory_order_relaxed);
+    }
+
+    bool CallbackStats::IsFiltered(uint32_t methodId) {
+        return methodId < kMaxMethods && g_Filtered[methodId].load(std::memory_order_relaxed);
+    }
+
+    void CallbackStats::Record(uint32_t methodId) {
+        if (methodId < kMaxMethods)
+            g_Calls[methodId].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void CallbackStats::Advance() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!g_AdvanceStarted) {
+            g_AdvanceStarted = true;
+            g_LastAdvance = now;
+            return;
+        }
+        if (now - g_LastAdvance < std::chrono::seconds(1))
+            return;
+        g_LastAdvance = now;
+
+        const uint32_t methodCount = std::min(NameTable::Count(), kMaxMethods);
+        size_t active = 0;
+
+        for (uint32_t id = 0; id < methodCount; ++id) {
+            const uint64_t calls = g_Calls[id].load(std::memory_order_relaxed);
+            const uint64_t delta = calls - g_LastCalls[id];
+            g_LastCalls[id] = calls;
+
+            if (delta)
+                g_AdvanceScratch[active++] = {id, delta};
+        }
+
+        const size_t kept = std::min(active, kTopPerSecond);
+        std::partial_sort(g_AdvanceScratch, g_AdvanceScratch + kept, g_AdvanceScratch + active, ByCallsDesc);
+
+        SecondFrame &frame = g_Frames[g_FrameCount % kHistorySeconds];
+        for (size_t i = 0; i < kept; ++i) {
+            frame.methodIds[i] = g_AdvanceScratch[i].methodId;
+            frame.calls[i] = static_cast<uint32_t>(std::min<uint64_t>(g_AdvanceScratch[i].calls, UINT32_MAX));
+        }
+        frame.count = static_cast<uint32_t>(kept);
+        g_FrameCount++;
+    }
+
+    size_t CallbackStats::Top(uint32_t windowSeconds, CallbackRate *out, size_t max, uint32_t &coveredSeconds) {
+        coveredSeconds = static_cast<uint32_t>(std::min<uint64_t>({windowSeconds, g_FrameCount, kHistorySeconds}));
+        if (coveredSeconds == 0 || !out || max == 0)
+            return 0;
+
+        return Collect(coveredSeconds, false, g_TopScratch, g_TopSums, out, max);
+    }
+
+    size_t CallbackStats::Totals(CallbackRate *out, size_t max, uint64_t &total) {
+        total = 0;
+        size_t kept = 0;
+        const uint32_t methodCount = std::min(NameTable::Count(), kMaxMethods);
+
+        // Keeps out as a min-heap of the max busiest methods seen so far, no scratch table shared with Advance().
+        const auto busierFirst = [](const CallbackRate &a, const CallbackRate &b) { return a.calls > b.calls; };
+        for (uint32_t id = 0; id < methodCount; ++id) {
+            const uint64_t calls = g_Calls[id].load(std::memory_order_relaxed);
+            total += calls;
+            if (!calls || !out || max == 0)
+                continue;
+
+            if (kept < max) {
+                out[kept++] = {id, calls};
+                std::push_heap(out, out + kept, busierFirst);
+            } else if (calls > out[0].calls) {
+                std::pop_heap(out, out + kept, busierFirst);
+                out[kept - 1] = {id, calls};
+                std::push_heap(out, out + kept, busierFirst);
+            }
+        }
+
+        if (kept)
+            std::sort_heap(out, out + kept, busierFirst);
+        return kept;
+    }
+
+    size_t CallbackStats::RecentForCrash(uint32_t windowSeconds, CallbackRate *out, size_t max) {
+        if (!out || max == 0)
+            return 0;
+
+        const auto seconds = static_cast<uint32_t>(std::min<uint64_t>({windowSeconds, g_FrameCount, kHistorySeconds}));
+        return Collect(seconds, true, g_CrashScratch, g_CrashSums, out, max);
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct CallbackRate {
+        uint32_t methodId;
+        uint64_t calls;
+    };
+
+    // Per-method call counters for C# callbacks. Record() is a relaxed atomic increment, Advance() snapshots the
+    // counters once per second into a fixed history so rates can be reported over the last 1-60 seconds.
+    class CallbackStats {
+    public:
+        static constexpr size_t kHistorySeconds = 64;
+        static constexpr size_t kTopPerSecond = 256;
+
+        static void SetFiltered(uint32_t methodId, bool filtered);
+
+        static bool IsFiltered(uint32_t methodId);
+
+        static void Record(uint32_t methodId);
+
+        static void Advance();
+
+        // Fills out with the busiest methods over the last windowSeconds completed seconds, sorted by call count.
+        // Returns the number of entries written, coveredSeconds receives how much history was actually available.
+        static size_t Top(uint32_t windowSeconds, CallbackRate *out, size_t max, uint32_t &coveredSeconds);
+
+        // Same as Top() but also counts the calls of the second in progress. Uses its own scratch tables so it is safe
+        // to call from the crash handler even if the game thread crashed inside Advance() or Top().
+        static size_t RecentForCrash(uint32_t windowSeconds, CallbackRate *out, size_t max);
+
+        // Calls since load, straight from the atomic counters so any thread may read them. Fills out with the most
+        // called methods and returns how many were written, total receives the calls of all methods.
+        static size_t Totals(CallbackRate *out, size_t max, uint64_t &total);
+    };
+}
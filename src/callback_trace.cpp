@@ -0,0 +1,507 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "callback_trace.h"
+#include "names.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace acceleratorcss {
+    namespace {
+        struct Slot {
+            // 2 * index + 1 while the record is being written, 2 * index + 2 once it is published.
+            std::atomic<uint64_t> seq{0};
+            CallbackTraceRecord record;
+        };
+
+        struct TimelineEntry {
+            uint64_t timestampNs;
+            size_t newest;
+        };
+
+        constexpr uint32_t kFileMagic = 0x54434341; // "ACCT"
+        constexpr uint32_t kFileVersion = 2;
+
+        enum class FileState : uint32_t {
+            Running = 1,
+            Clean,
+            CrashReported,
+        };
+
+        // Start of the backing file, the slots follow it. Also used for heap rings so writers need no branches.
+        struct alignas(64) FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t slotSize;
+            uint32_t capacity;
+            int32_t pid;
+            std::atomic<FileState> state;
+            // Start time of the owning process in clock ticks since boot, with the boot id it is relative to. Pids
+            // repeat across container restarts, this pair does not.
+            uint64_t processStartTicks;
+            char bootId[40];
+            int64_t startedUnixSec;
+            std::atomic<int64_t> heartbeatUnixSec;
+            std::atomic<uint64_t> tick;
+            std::atomic<uint64_t> head;
+            char map[64];
+        };
+
+        struct Ring {
+            size_t capacity;
+            FileHeader *header;
+            Slot *slots;
+            TimelineEntry *timeline;
+        };
+
+        std::atomic<Ring *> g_Ring{nullptr};
+        std::string g_BackingPath;
+        char g_Map[64];
+        int64_t g_StartedUnixSec = 0;
+
+        struct ProcessIdentity {
+            uint64_t startTicks;
+            char bootId[40];
+        };
+
+        // Field 22 of /proc/self/stat and /proc/sys/kernel/random/boot_id, read once.
+        const ProcessIdentity &CurrentProcess() {
+            static const ProcessIdentity identity = [] {
+                ProcessIdentity result{};
+                if (FILE *stat = std::fopen("/proc/self/stat", "r")) {
+                    char line[1024];
+                    const size_t len = std::fread(line, 1, sizeof(line) - 1, stat);
+                    std::fclose(stat);
+                    line[len] = '\0';
+
+                    // The command name in field 2 may contain spaces, the fields after it are counted from its ')'.
+                    if (const char *field = std::strrchr(line, ')')) {
+                        for (int i = 2; i < 22 && field; ++i)
+                            field = std::strchr(field + 1, ' ');
+                        if (field)
+                            result.startTicks = std::strtoull(field + 1, nullptr, 10);
+                    }
+                }
+                if (FILE *boot = std::fopen("/proc/sys/kernel/random/boot_id", "r")) {
+                    if (std::fgets(result.bootId, sizeof(result.bootId), boot))
+                        result.bootId[std::strcspn(result.bootId, "\n")] = '\0';
+                    std::fclose(boot);
+                }
+                return result;
+            }();
+            return identity;
+        }
+
+        // Returns the header followed by capacity slots, from the backing file when one is set.
+        FileHeader *MapStorage(size_t capacity) {
+            const size_t bytes = sizeof(FileHeader) + capacity * sizeof(Slot);
+
+            if (!g_BackingPath.empty()) {
+                // Unlinked first, writers may still be using the previous ring and must not see its file shrink.
+                unlink(g_BackingPath.c_str());
+                const int fd = open(g_BackingPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd >= 0) {
+                    void *mapping = MAP_FAILED;
+                    if (ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+                        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    close(fd);
+                    if (mapping != MAP_FAILED)
+                        return new(mapping) FileHeader{};
+                }
+            }
+
+            // Zeroed like a fresh file, so every slot starts with seq 0.
+            void *memory = ::operator new(bytes, std::align_val_t{alignof(FileHeader)});
+            std::memset(memory, 0, bytes);
+            return new(memory) FileHeader{};
+        }
+
+        bool ReadSlot(const Ring *ring, size_t newest, CallbackTraceRecord *out, uint64_t &timestampNs) {
+            const uint64_t head = ring->header->head.load(std::memory_order_acquire);
+            if (newest >= std::min<uint64_t>(head, ring->capacity))
+                return false;
+
+            const uint64_t index = head - 1 - newest;
+            const Slot &slot = ring->slots[index % ring->capacity];
+
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before != 2 * index + 2)
+                return false;
+
+            timestampNs = slot.record.timestampNs;
+            if (out) {
+                std::memcpy(out, &slot.record, offsetof(CallbackTraceRecord, args));
+                std::memcpy(out->args, slot.record.args, std::min<size_t>(out->argsLen, sizeof(out->args)));
+                std::memcpy(out->frames, slot.record.frames,
+                            std::min<size_t>(out->frameCount, CallbackTraceRecord::kMaxFrames) * sizeof(CallbackFrame));
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.seq.load(std::memory_order_relaxed) == before;
+        }
+
+        template<typename NameLookup>
+        size_t FormatFrameWith(const CallbackFrame &frame, char *out, size_t size, NameLookup name) {
+            // IL offset is -1 when the runtime could not map the native IP back, e.g. for frames in dynamic methods.
+            const int written = frame.ilOffset >= 0
+                                    ? std::snprintf(out, size, "%s +IL_%04x", name(frame.methodId), frame.ilOffset)
+                                    : std::snprintf(out, size, "%s", name(frame.methodId));
+            return written < 0 ? 0 : std::min(static_cast<size_t>(written), size ? size - 1 : 0);
+        }
+
+        template<typename NameLookup>
+        size_t FormatArgsWith(const CallbackTraceRecord &record, char *out, size_t size, NameLookup name) {
+            if (size == 0)
+                return 0;
+
+            const uint8_t *data = record.args;
+            const uint8_t *end = data + std::min<size_t>(record.argsLen, sizeof(record.args));
+            size_t len = 0;
+            out[0] = '\0';
+
+            // Values are read with memcpy, they follow variable length strings and are not aligned.
+            auto take = [&](auto &value) {
+                if (end - data < static_cast<ptrdiff_t>(sizeof(value)))
+                    return false;
+                std::memcpy(&value, data, sizeof(value));
+                data += sizeof(value);
+                return true;
+            };
+            auto append = [&](const char *fmt, auto... values) {
+                if (len + 1 >= size)
+                    return;
+                const int written = std::snprintf(out + len, size - len, fmt, values...);
+                if (written > 0)
+                    len = std::min(len + static_cast<size_t>(written), size - 1);
+            };
+
+            bool first = true;
+            while (data < end) {
+                const auto tag = static_cast<ArgTag>(*data++);
+                if (!first)
+                    append(", ");
+                first = false;
+
+                switch (tag) {
+                    case ArgTag::Null:
+                        append("null");
+                        break;
+                    case ArgTag::Bool: {
+                        uint8_t value;
+                        if (!take(value))
+                            return len;
+                        append("%s", value ? "true" : "false");
+                        break;
+                    }
+                    case ArgTag::Int: {
+                        int64_t value;
+                        if (!take(value))
+                            return len;
+                        append("%lld", static_cast<long long>(value));
+                        break;
+                    }
+                    case ArgTag::UInt: {
+                        uint64_t value;
+                        if (!take(value))
+                            return len;
+                        append("%llu", static_cast<unsigned long long>(value));
+                        break;
+                    }
+                    case ArgTag::Float: {
+                        double value;
+                        if (!take(value))
+                            return len;
+                        append("%g", value);
+                        break;
+                    }
+                    case ArgTag::String: {
+                        uint8_t length;
+                        if (!take(length) || end - data < length)
+                            return len;
+                        append("\"%.*s\"", static_cast<int>(length), reinterpret_cast<const char *>(data));
+                        data += length;
+                        break;
+                    }
+                    case ArgTag::Entity: {
+                        uint32_t typeId, handle;
+                        if (!take(typeId) || !take(handle))
+                            return len;
+                        if (handle == UINT32_MAX)
+                            append("%s#invalid", name(typeId));
+                        else
+                            append("%s#%u", name(typeId), handle & 0x7fff);
+                        break;
+                    }
+                    case ArgTag::Enum: {
+                        uint32_t typeId;
+                        int64_t value;
+                        if (!take(typeId) || !take(value))
+                            return len;
+                        append("%s(%lld)", name(typeId), static_cast<long long>(value));
+                        break;
+                    }
+                    case ArgTag::Object: {
+                        uint32_t typeId;
+                        if (!take(typeId))
+                            return len;
+                        append("[%s]", name(typeId));
+                        break;
+                    }
+                    case ArgTag::Truncated:
+                        append("...");
+                        return len;
+                    default:
+                        append("[bad tag %u]", static_cast<unsigned>(tag));
+                        return len;
+                }
+            }
+
+            return len;
+        }
+    }
+
+    void CallbackTrace::SetBackingFile(const std::string &path) {
+        g_BackingPath = path;
+    }
+
+    void CallbackTrace::Resize(size_t capacity) {
+        if (capacity == 0)
+            return;
+        capacity = std::min(capacity, kMaxCapacity);
+
+        FileHeader *header = MapStorage(capacity);
+        header->magic = kFileMagic;
+        header->version = kFileVersion;
+        header->slotSize = sizeof(Slot);
+        header->capacity = static_cast<uint32_t>(capacity);
+        header->pid = getpid();
+        header->processStartTicks = CurrentProcess().startTicks;
+        std::memcpy(header->bootId, CurrentProcess().bootId, sizeof(header->bootId));
+        header->startedUnixSec = g_StartedUnixSec ? g_StartedUnixSec : (g_StartedUnixSec = std::time(nullptr));
+        header->heartbeatUnixSec.store(std::time(nullptr), std::memory_order_relaxed);
+        header->tick.store(g_ServerTick.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::memcpy(header->map, g_Map, sizeof(header->map));
+        header->state.store(FileState::Running, std::memory_order_release);
+
+        auto *ring = new Ring;
+        ring->capacity = capacity;
+        ring->header = header;
+        ring->slots = reinterpret_cast<Slot *>(header + 1);
+        ring->timeline = new TimelineEntry[capacity];
+
+        // The previous ring is intentionally leaked, a callback on another thread may still be writing into it.
+        g_Ring.store(ring, std::memory_order_release);
+    }
+
+    void CallbackTrace::Heartbeat(uint64_t tick) {
+        Ring *ring = g_Ring.load(std::memory_order_acquire);
+        if (!ring)
+            return;
+
+        ring->header->tick.store(tick, std::memory_order_relaxed);
+        ring->header->heartbeatUnixSec.store(std::time(nullptr), std::memory_order_relaxed);
+    }
+
+    void CallbackTrace::SetMap(const char *map) {
+        std::snprintf(g_Map, sizeof(g_Map), "%s", map ? map : "");
+
+        if (Ring *ring = g_Ring.load(std::memory_order_acquire))
+            std::memcpy(ring->header->map, g_Map, sizeof(g_Map));
+    }
+
+    void CallbackTrace::MarkClean() {
+        if (Ring *ring = g_Ring.load(std::memory_order_acquire))
+            ring->header->state.store(FileState::Clean, std::memory_order_release);
+    }
+
+    void CallbackTrace::MarkCrashReported() {
+        if (Ring *ring = g_Ring.load(std::memory_order_acquire))
+            ring->header->state.store(FileState::CrashReported, std::memory_order_release);
+    }
+
+    bool CallbackTrace::RecoverUnclean(const std::string &path, const std::string &namesPath,
+                                       const std::string &reportPath) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        struct stat st{};
+        void *mapping = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(FileHeader))
+            mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        auto *header = static_cast<FileHeader *>(mapping);
+        const bool valid = header->magic == kFileMagic && header->version == kFileVersion &&
+                           header->slotSize == sizeof(Slot) && header->capacity <= kMaxCapacity &&
+                           static_cast<size_t>(st.st_size) >= sizeof(FileHeader) + header->capacity * sizeof(Slot);
+
+        // The caller holds the trace lock, so no other live server owns this ring. A ring still running under this
+        // process's identity only means the plugin was reloaded without an unload.
+        const ProcessIdentity &self = CurrentProcess();
+        const bool sameProcess = header->processStartTicks == self.startTicks &&
+                                 std::strncmp(header->bootId, self.bootId, sizeof(header->bootId)) == 0;
+        const bool unclean = valid && header->state.load() == FileState::Running && !sameProcess;
+
+        FILE *report = unclean ? std::fopen(reportPath.c_str(), "w") : nullptr;
+        if (!report) {
+            munmap(mapping, st.st_size);
+            return false;
+        }
+
+        std::vector<std::string> names;
+        NameTable::ReadPersisted(namesPath, names);
+        auto name = [&names](uint32_t id) { return id < names.size() ? names[id].c_str() : "[unknown]"; };
+
+        char started[32], heartbeat[32];
+        const time_t startedTime = header->startedUnixSec;
+        const time_t heartbeatTime = header->heartbeatUnixSec.load();
+        std::strftime(started, sizeof(started), "%Y-%m-%d %H:%M:%S UTC", std::gmtime(&startedTime));
+        std::strftime(heartbeat, sizeof(heartbeat), "%Y-%m-%d %H:%M:%S UTC", std::gmtime(&heartbeatTime));
+
+        std::fprintf(report, "-------- UNCLEAN SHUTDOWN --------\n");
+        std::fprintf(report, "The previous server process (pid %d) ended without an unload or a crash report,\n"
+                             "most likely SIGKILL (OOM killer, watchdog) or a hang that was killed.\n", header->pid);
+        std::fprintf(report, "Started: %s\nLast heartbeat: %s\nLast tick: %llu\nMap: %.*s\n\n", started, heartbeat,
+                     static_cast<unsigned long long>(header->tick.load()), static_cast<int>(sizeof(header->map)),
+                     header->map);
+
+        Ring ring{header->capacity, header, reinterpret_cast<Slot *>(header + 1), nullptr};
+        auto *record = new CallbackTraceRecord;
+        char text[4096];
+        uint64_t newestNs = 0;
+
+        // Writers publish in claim order, which is close enough to time order for a post-mortem.
+        std::fprintf(report, "-------- CALLBACK TRACE BEGIN -> NEWEST CALLBACK IS FIRST --------\n");
+        for (size_t i = 0; i < ring.capacity; ++i) {
+            uint64_t timestampNs;
+            if (!ReadSlot(&ring, i, record, timestampNs))
+                continue;
+            if (!newestNs)
+                newestNs = timestampNs;
+
+            std::fprintf(report, "[-%.3f ms] tick %llu, thread %d (managed %d)\nName: %s\n",
+                         static_cast<double>(static_cast<int64_t>(newestNs - timestampNs)) / 1e6,
+                         static_cast<unsigned long long>(record->tick), record->tid, record->managedTid,
+                         name(record->methodId));
+            if (record->argsLen) {
+                FormatArgsWith(*record, text, sizeof(text), name);
+                std::fprintf(report, "Args: %s\n", text);
+            }
+            if (record->frameCount)
+                std::fprintf(report, "Stack:\n");
+            for (size_t frame = 0; frame < record->frameCount; ++frame) {
+                FormatFrameWith(record->frames[frame], text, sizeof(text), name);
+                std::fprintf(report, "   at %s\n", text);
+            }
+            std::fprintf(report, "-----------------------------\n");
+        }
+        std::fprintf(report, "-------- CALLBACK TRACE END --------\n");
+
+        delete record;
+        std::fclose(report);
+        munmap(mapping, st.st_size);
+
+        // Reported once, even if this process never creates a ring of its own.
+        unlink(path.c_str());
+        return true;
+    }
+
+    void CallbackTrace::Push(uint32_t methodId, int managedTid, const void *args, size_t argsLen,
+                             const void *frames, size_t frameCount) {
+        Ring *ring = g_Ring.load(std::memory_order_acquire);
+        if (!ring)
+            return;
+
+        const uint64_t index = ring->header->head.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = ring->slots[index % ring->capacity];
+
+        slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        CallbackTraceRecord &record = slot.record;
+        record.timestampNs = MonotonicNs();
+        record.tick = g_ServerTick.load(std::memory_order_relaxed);
+        record.methodId = methodId;
+        record.tid = CurrentThreadId();
+        record.managedTid = managedTid;
+        record.argsLen = static_cast<uint16_t>(std::min(argsLen, sizeof(record.args)));
+        record.frameCount = static_cast<uint16_t>(std::min(frameCount, CallbackTraceRecord::kMaxFrames));
+        if (record.argsLen)
+            std::memcpy(record.args, args, record.argsLen);
+        // The frames follow the variable length arguments in the managed payload and may be unaligned.
+        if (record.frameCount)
+            std::memcpy(record.frames, frames, record.frameCount * sizeof(CallbackFrame));
+
+        slot.seq.store(2 * index + 2, std::memory_order_release);
+    }
+
+    size_t CallbackTrace::Count() {
+        const Ring *ring = g_Ring.load(std::memory_order_acquire);
+        if (!ring)
+            return 0;
+
+        return std::min<uint64_t>(ring->header->head.load(std::memory_order_acquire), ring->capacity);
+    }
+
+    bool CallbackTrace::Read(size_t newest, CallbackTraceRecord &out) {
+        const Ring *ring = g_Ring.load(std::memory_order_acquire);
+        uint64_t timestampNs;
+        return ring && ReadSlot(ring, newest, &out, timestampNs);
+    }
+
+    size_t CallbackTrace::Timeline(size_t *order, size_t max) {
+        const Ring *ring = g_Ring.load(std::memory_order_acquire);
+        if (!ring || !order)
+            return 0;
+
+        size_t count = 0;
+        const size_t available = std::min(Count(), max);
+        for (size_t i = 0; i < available; ++i) {
+            uint64_t timestampNs;
+            if (ReadSlot(ring, i, nullptr, timestampNs))
+                ring->timeline[count++] = {timestampNs, i};
+        }
+
+        std::sort(ring->timeline, ring->timeline + count, [](const TimelineEntry &a, const TimelineEntry &b) {
+            return a.timestampNs > b.timestampNs;
+        });
+
+        for (size_t i = 0; i < count; ++i)
+            order[i] = ring->timeline[i].newest;
+
+        return count;
+    }
+
+    size_t CallbackTrace::FormatFrame(const CallbackFrame &frame, char *out, size_t size) {
+        return FormatFrameWith(frame, out, size, NameTable::Get);
+    }
+
+    size_t CallbackTrace::FormatArgs(const CallbackTraceRecord &record, char *out, size_t size) {
+        return FormatArgsWith(record, out, size, NameTable::Get);
+    }
+
+    bool CallbackTrace::Storage(const void *&data, size_t &bytes) {
+        const Ring *ring = g_Ring.load(std::memory_order_acquire);
+        if (!ring)
+            return false;
+
+        data = ring->slots;
+        bytes = ring->capacity * sizeof(Slot);
+        return true;
+    }
+}
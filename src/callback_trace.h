@@ -0,0 +1,97 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace acceleratorcss {
+    // One managed frame, kept as a name id and IL offset so the string is only built when a report is written.
+    struct CallbackFrame {
+        uint32_t methodId;
+        int32_t ilOffset;
+    };
+
+    // Callback arguments as written by the managed side: a tag byte followed by its value, all little endian.
+    // Nothing is converted to text until a report is written, so plugin ToString() overrides never run.
+    enum class ArgTag : uint8_t {
+        Null,      // no value
+        Bool,      // uint8
+        Int,       // int64, every signed integer type and char
+        UInt,      // uint64, every unsigned integer type
+        Float,     // double
+        String,    // uint8 length, then that many UTF-8 bytes (truncated)
+        Entity,    // uint32 type name id, uint32 raw entity handle
+        Enum,      // uint32 type name id, int64 value
+        Object,    // uint32 type name id
+        Truncated, // no value, the remaining arguments did not fit
+    };
+
+    struct CallbackTraceRecord {
+        static constexpr size_t kMaxFrames = 64;
+        static constexpr size_t kMaxArgBytes = 512;
+
+        uint64_t timestampNs;
+        uint64_t tick;
+        uint32_t methodId;
+        int tid;
+        int managedTid;
+        uint16_t argsLen;
+        uint16_t frameCount;
+        uint8_t args[kMaxArgBytes];
+        CallbackFrame frames[kMaxFrames];
+    };
+
+    // Ring of the most recent callback records. Writers claim a slot with a single atomic increment and publish it
+    // with a per-slot sequence number, so there is no lock the crash handler could deadlock on.
+    //
+    // With a backing file the ring and a small header (map, tick, heartbeat) live in a MAP_SHARED mapping, so the
+    // kernel keeps them even when the process is SIGKILLed or OOM killed and Breakpad never runs.
+    class CallbackTrace {
+    public:
+        static constexpr size_t kMaxCapacity = 4096;
+
+        // Rings created by later Resize() calls are mapped from this file. Must be called before the first Resize().
+        static void SetBackingFile(const std::string &path);
+
+        static void Resize(size_t capacity);
+
+        // Updates the persisted header, called once per server frame.
+        static void Heartbeat(uint64_t tick);
+
+        static void SetMap(const char *map);
+
+        // Marks the persisted ring as properly closed, either by an unload or by the crash handler.
+        static void MarkClean();
+
+        static void MarkCrashReported();
+
+        // Converts a ring left behind by a process that died without MarkClean()/MarkCrashReported() into a text
+        // report, resolving names with the pool persisted next to it. Returns true when a report was written. The
+        // caller must hold the lock that keeps other servers off path.
+        static bool RecoverUnclean(const std::string &path, const std::string &namesPath, const std::string &reportPath);
+
+        static void Push(uint32_t methodId, int managedTid, const void *args, size_t argsLen,
+                         const void *frames, size_t frameCount);
+
+        static size_t Count();
+
+        // Copies the n-th newest record into out. Fails if the slot is being written or was already overwritten.
+        static bool Read(size_t newest, CallbackTraceRecord &out);
+
+        // Fills order with the indexes accepted by Read(), sorted newest first by timestamp. Returns the count.
+        static size_t Timeline(size_t *order, size_t max);
+
+        // Formats a frame as "Namespace.Type::Method +IL_0012" into out, returns the length without the terminator.
+        static size_t FormatFrame(const CallbackFrame &frame, char *out, size_t size);
+
+        // Formats the encoded arguments as a comma separated list into out, returns the length without the terminator.
+        static size_t FormatArgs(const CallbackTraceRecord &record, char *out, size_t size);
+
+        // Memory holding the records of the current ring, so it can be included in minidumps.
+        static bool Storage(const void *&data, size_t &bytes);
+    };
+}
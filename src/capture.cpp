@@ -0,0 +1,188 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "capture.h"
+#include "helper_threads.h"
+#include "log.h"
+#include "names.h"
+#include "timing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr uint64_t kCapacity = 1 << 18;
+
+        struct Event {
+            std::atomic<uint64_t> seq{0};
+            uint64_t timestampNs;
+            uint32_t value;
+            int tid;
+            TraceCapture::Phase phase;
+        };
+
+        // Allocated on the first capture and kept, a late producer may still touch it after a capture ends.
+        Event *g_Events = nullptr;
+        std::atomic<uint64_t> g_Head{0};
+        std::atomic<uint64_t> g_Tail{0};
+        std::atomic<uint64_t> g_Dropped{0};
+
+        std::mutex g_ControlMutex;
+        std::thread g_WriterThread;
+        std::atomic<bool> g_StopRequested{false};
+        std::atomic<bool> g_Active{false};
+
+        // Same escaping as CrashWriter::JsonString, without the surrounding quotes. Names come from plugin code and may
+        // contain anything, one bad character would make the whole capture unreadable.
+        void WriteJsonEscaped(FILE *file, const char *str) {
+            static const char kHex[] = "0123456789abcdef";
+
+            for (const char *p = str; *p; ++p) {
+                const auto c = static_cast<unsigned char>(*p);
+                switch (c) {
+                    case '"': std::fputs("\\\"", file); break;
+                    case '\\': std::fputs("\\\\", file); break;
+                    case '\n': std::fputs("\\n", file); break;
+                    case '\r': std::fputs("\\r", file); break;
+                    case '\t': std::fputs("\\t", file); break;
+                    default:
+                        if (c < 0x20)
+                            std::fprintf(file, "\\u00%c%c", kHex[c >> 4], kHex[c & 0xF]);
+                        else
+                            std::fputc(c, file);
+                }
+            }
+        }
+
+        void WriteEvent(FILE *file, const Event &event, uint64_t startNs) {
+            // Events published late by a producer of a previous capture.
+            if (event.timestampNs < startNs)
+                return;
+
+            const double ts = static_cast<double>(event.timestampNs - startNs) / 1000.0;
+            const int pid = getpid();
+
+            std::fputs(",\n", file);
+            switch (event.phase) {
+                case TraceCapture::Phase::Enter:
+                case TraceCapture::Phase::Exit: {
+                    std::fputs("{\"name\":\"", file);
+                    WriteJsonEscaped(file, NameTable::Get(event.value));
+                    std::fprintf(file, "\",\"cat\":\"callback\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                                 event.phase == TraceCapture::Phase::Enter ? 'B' : 'E', ts, pid, event.tid);
+                    break;
+                }
+                case TraceCapture::Phase::Tick:
+                    std::fprintf(file, "{\"name\":\"tick %u\",\"cat\":\"tick\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%.3f,"
+                                       "\"pid\":%d,\"tid\":%d}", event.value, ts, pid, event.tid);
+                    break;
+            }
+        }
+
+        void WriterLoop(FILE *file, std::string path, uint64_t startNs, std::chrono::steady_clock::time_point deadline) {
+            HelperThreads::Enter("capture");
+            std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+            std::fprintf(file, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"game\"}}",
+                         getpid(), g_GameThreadId.load());
+
+            while (true) {
+                const bool stopping = g_StopRequested.load() || std::chrono::steady_clock::now() >= deadline;
+                if (stopping)
+                    g_StopRequested.store(true);
+
+                uint64_t tail = g_Tail.load(std::memory_order_relaxed);
+                while (true) {
+                    Event &event = g_Events[tail % kCapacity];
+                    if (event.seq.load(std::memory_order_acquire) != tail + 1)
+                        break;
+
+                    WriteEvent(file, event, startNs);
+                    ++tail;
+                    g_Tail.store(tail, std::memory_order_release);
+                }
+
+                if (stopping)
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+
+            std::fputs("\n]}\n", file);
+            std::fclose(file);
+            g_Active.store(false, std::memory_order_release);
+
+            ACC_CORE_INFO("Callback capture written to: {} (dropped {} events)", path, g_Dropped.exchange(0));
+        }
+    }
+
+    bool TraceCapture::Start(uint32_t seconds, const std::string &outputDirectory) {
+        std::lock_guard lock(g_ControlMutex);
+
+        if (g_Active.load())
+            return false;
+        if (g_WriterThread.joinable())
+            g_WriterThread.join();
+
+        if (!g_Events)
+            g_Events = new Event[kCapacity];
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "/capture_%ld.json", static_cast<long>(std::time(nullptr)));
+        std::string path = outputDirectory + name;
+
+        FILE *file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            ACC_CORE_ERROR("Failed to open capture file: {}", path);
+            return false;
+        }
+
+        g_StopRequested.store(false);
+        g_Dropped.store(0);
+        g_Active.store(true, std::memory_order_release);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        g_WriterThread = std::thread(WriterLoop, file, path, MonotonicNs(), deadline);
+
+        ACC_CORE_INFO("Capturing callbacks for {}s into {}", seconds, path);
+        return true;
+    }
+
+    void TraceCapture::Stop() {
+        std::lock_guard lock(g_ControlMutex);
+
+        g_StopRequested.store(true);
+        if (g_WriterThread.joinable())
+            g_WriterThread.join();
+        g_Active.store(false, std::memory_order_release);
+    }
+
+    bool TraceCapture::IsActive() {
+        return g_Active.load(std::memory_order_relaxed);
+    }
+
+    void TraceCapture::Record(Phase phase, uint32_t value) {
+        if (!g_Events || g_StopRequested.load(std::memory_order_relaxed))
+            return;
+
+        uint64_t head = g_Head.load(std::memory_order_relaxed);
+        do {
+            if (head - g_Tail.load(std::memory_order_acquire) >= kCapacity) {
+                g_Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        } while (!g_Head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed));
+
+        Event &event = g_Events[head % kCapacity];
+        event.timestampNs = MonotonicNs();
+        event.value = value;
+        event.tid = CurrentThreadId();
+        event.phase = phase;
+        event.seq.store(head + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,30 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace acceleratorcss {
+    // On-demand capture of the callback enter/exit stream as a Chrome Trace Event file (chrome://tracing, Perfetto).
+    // Producers push into a bounded ring that is drained to disk by a helper thread, so memory stays fixed no
+    // matter how long the capture runs, events are dropped when the writer cannot keep up.
+    class TraceCapture {
+    public:
+        enum class Phase : uint8_t {
+            Enter,
+            Exit,
+            Tick,
+        };
+
+        static bool Start(uint32_t seconds, const std::string &outputDirectory);
+
+        static void Stop();
+
+        static bool IsActive();
+
+        static void Record(Phase phase, uint32_t value);
+    };
+}
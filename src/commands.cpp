@@ -0,0 +1,288 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "extension.h"
+#include "callback_stats.h"
+#include "callback_trace.h"
+#include "capture.h"
+#include "exception_trace.h"
+#include "game_event_trace.h"
+#include "names.h"
+#include "net_trace.h"
+#include "sched_stats.h"
+#include "tick_stats.h"
+#include "timing.h"
+#include "trace_governor.h"
+
+#include <tier1/convar.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using acceleratorcss::CallbackRate;
+using acceleratorcss::CallbackStats;
+using acceleratorcss::CallbackTrace;
+using acceleratorcss::CallbackTraceRecord;
+using acceleratorcss::ExceptionRecord;
+using acceleratorcss::ExceptionTrace;
+using acceleratorcss::GameEventRate;
+using acceleratorcss::GameEventTrace;
+using acceleratorcss::GcSnapshot;
+using acceleratorcss::NameTable;
+using acceleratorcss::NetMessageRate;
+using acceleratorcss::NetMessageTrace;
+using acceleratorcss::PluginAllocationRate;
+using acceleratorcss::SchedStats;
+using acceleratorcss::SchedSummary;
+using acceleratorcss::TickSample;
+using acceleratorcss::TickStats;
+using acceleratorcss::TraceCapture;
+using acceleratorcss::TraceGovernor;
+using acceleratorcss::TraceOverheadSecond;
+
+CON_COMMAND_F(acc_top_callbacks, "Prints the most called C# callbacks over the last 1s/10s/60s. Usage: acc_top_callbacks [count]",
+              FCVAR_NONE) {
+    constexpr size_t kMaxCount = 100;
+    constexpr uint32_t kWindows[] = {1, 10, 60};
+
+    size_t count = 10;
+    if (args.ArgC() > 1)
+        count = std::clamp(std::atoi(args[1]), 1, static_cast<int>(kMaxCount));
+
+    CallbackRate top[kMaxCount];
+
+    for (uint32_t window: kWindows) {
+        uint32_t covered = 0;
+        const size_t found = CallbackStats::Top(window, top, count, covered);
+
+        META_CONPRINTF("-------- TOP CALLBACKS LAST %us (calls/sec) --------\n", window);
+        if (covered < window)
+            META_CONPRINTF("(only %us of history available)\n", covered);
+
+        for (size_t i = 0; i < found; ++i) {
+            META_CONPRINTF("%3zu. %10.1f  %s\n", i + 1, static_cast<double>(top[i].calls) / covered,
+                           NameTable::Get(top[i].methodId));
+        }
+    }
+}
+
+CON_COMMAND_F(acc_capture, "Captures the C# callback timeline into a Chrome trace file. Usage: acc_capture [seconds|stop]",
+              FCVAR_NONE) {
+    constexpr int kMaxSeconds = 120;
+
+    if (args.ArgC() > 1 && std::strcmp(args[1], "stop") == 0) {
+        TraceCapture::Stop();
+        META_CONPRINTF("Callback capture stopped.\n");
+        return;
+    }
+
+    int seconds = 5;
+    if (args.ArgC() > 1)
+        seconds = std::clamp(std::atoi(args[1]), 1, kMaxSeconds);
+
+    if (!TraceCapture::Start(static_cast<uint32_t>(seconds), acceleratorcss::Paths::Logs()))
+        META_CONPRINTF("A callback capture is already running or the file could not be created.\n");
+}
+
+CON_COMMAND_F(acc_trace, "Prints the most recent traced C# callbacks with their arguments and stacks. Usage: acc_trace [count]", FCVAR_NONE) {
+    constexpr int kMaxCount = 50;
+
+    size_t count = 5;
+    if (args.ArgC() > 1)
+        count = std::clamp(std::atoi(args[1]), 1, kMaxCount);
+
+    // Records are over 1 KB each, too large for a stack array of them.
+    static CallbackTraceRecord record;
+    const uint64_t now = acceleratorcss::MonotonicNs();
+    char text[4096];
+
+    META_CONPRINTF("-------- RECENT CALLBACKS (newest first) --------\n");
+    for (size_t i = 0; i < std::min(count, CallbackTrace::Count()); ++i) {
+        if (!CallbackTrace::Read(i, record))
+            continue;
+
+        META_CONPRINTF("[-%.3f ms] %s (thread %d)\n", static_cast<double>(now - record.timestampNs) / 1e6,
+                       NameTable::Get(record.methodId), record.tid);
+        if (record.argsLen) {
+            CallbackTrace::FormatArgs(record, text, sizeof(text));
+            META_CONPRINTF("  Args: %s\n", text);
+        }
+        for (size_t f = 0; f < record.frameCount; ++f) {
+            CallbackTrace::FormatFrame(record.frames[f], text, sizeof(text));
+            META_CONPRINTF("    at %s\n", text);
+        }
+    }
+}
+
+CON_COMMAND_F(acc_exceptions, "Prints first-chance C# exception counts and the most recent exceptions. Usage: acc_exceptions [count]",
+              FCVAR_NONE) {
+    constexpr size_t kSeconds = 10;
+
+    size_t count = 10;
+    if (args.ArgC() > 1)
+        count = std::clamp(std::atoi(args[1]), 1, static_cast<int>(ExceptionTrace::kCapacity));
+
+    uint32_t perSecond[kSeconds];
+    const size_t seconds = ExceptionTrace::PerSecond(perSecond, kSeconds);
+
+    META_CONPRINTF("-------- FIRST-CHANCE EXCEPTIONS PER SECOND (newest first) --------\n");
+    for (size_t i = 0; i < seconds; ++i)
+        META_CONPRINTF("%u ", perSecond[i]);
+    META_CONPRINTF("\n");
+
+    ExceptionRecord recent[ExceptionTrace::kCapacity];
+    const size_t found = ExceptionTrace::Recent(recent, count);
+    const uint64_t now = acceleratorcss::MonotonicNs();
+
+    META_CONPRINTF("-------- RECENT EXCEPTIONS --------\n");
+    for (size_t i = 0; i < found; ++i) {
+        META_CONPRINTF("[-%.1fs] %s (0x%08x) in %s\n", static_cast<double>(now - recent[i].timestampNs) / 1e9,
+                       NameTable::Get(recent[i].typeId), static_cast<uint32_t>(recent[i].hresult),
+                       NameTable::Get(recent[i].methodId));
+    }
+}
+
+CON_COMMAND_F(acc_gc, "Prints managed GC state, per-plugin allocation rates and the slowest recent ticks.", FCVAR_NONE) {
+    constexpr size_t kSlowest = 5;
+
+    const GcSnapshot &gc = TickStats::LatestGc();
+    META_CONPRINTF("-------- GC --------\n");
+    META_CONPRINTF("Collections gen0/1/2: %u/%u/%u\n", gc.gen0Collections, gc.gen1Collections, gc.gen2Collections);
+    META_CONPRINTF("Heap: %.1f MB (fragmented %.1f MB), allocated total: %.1f MB\n",
+                   static_cast<double>(gc.heapSizeBytes) / (1024 * 1024),
+                   static_cast<double>(gc.fragmentedBytes) / (1024 * 1024),
+                   static_cast<double>(gc.allocatedBytes) / (1024 * 1024));
+    META_CONPRINTF("Pause total: %.2f ms, last: %.2f ms (gen%u)\n", static_cast<double>(gc.totalPauseNs) / 1e6,
+                   static_cast<double>(gc.lastPauseNs) / 1e6, gc.lastPauseGeneration);
+
+    PluginAllocationRate plugins[TickStats::kMaxPlugins];
+    const size_t pluginCount = TickStats::PluginRates(plugins, TickStats::kMaxPlugins);
+    META_CONPRINTF("-------- ALLOCATION RATE BY PLUGIN (callbacks only) --------\n");
+    for (size_t i = 0; i < pluginCount; ++i)
+        META_CONPRINTF("%10.1f KB/s  %s\n", static_cast<double>(plugins[i].bytesPerSec) / 1024,
+                       NameTable::Get(plugins[i].nameId));
+
+    TickSample ticks[TickStats::kHistoryTicks];
+    const size_t tickCount = TickStats::Recent(ticks, TickStats::kHistoryTicks);
+    const size_t slowest = std::min(kSlowest, tickCount);
+    std::partial_sort(ticks, ticks + slowest, ticks + tickCount, [](const TickSample &a, const TickSample &b) {
+        return a.durationNs > b.durationNs;
+    });
+
+    META_CONPRINTF("-------- SLOWEST OF THE LAST %zu TICKS --------\n", tickCount);
+    for (size_t i = 0; i < slowest; ++i)
+        META_CONPRINTF("tick %llu: %.2f ms\n", static_cast<unsigned long long>(ticks[i].tick),
+                       static_cast<double>(ticks[i].durationNs) / 1e6);
+}
+
+CON_COMMAND_F(acc_sched, "Prints the game thread's run queue delay histogram, context switches and host CPU steal. "
+                         "Usage: acc_sched [seconds]", FCVAR_NONE) {
+    uint32_t seconds = 10;
+    if (args.ArgC() > 1)
+        seconds = std::clamp(std::atoi(args[1]), 1, static_cast<int>(SchedStats::kHistorySeconds));
+
+    SchedSummary summary;
+    if (!SchedStats::Summary(seconds, summary) || summary.ticks == 0) {
+        META_CONPRINTF("No scheduler history yet.\n");
+        return;
+    }
+
+    META_CONPRINTF("-------- GAME THREAD SCHEDULING, LAST %us (%llu ticks) --------\n", summary.seconds,
+                   static_cast<unsigned long long>(summary.ticks));
+    META_CONPRINTF("On CPU: %.2f ms/tick, run queue wait: %.3f ms/tick (max %.2f ms)\n",
+                   static_cast<double>(summary.cpuNs) / 1e6 / summary.ticks,
+                   static_cast<double>(summary.runDelayNs) / 1e6 / summary.ticks,
+                   static_cast<double>(summary.maxRunDelayNs) / 1e6);
+    META_CONPRINTF("Context switches: %.1f voluntary/s, %.1f involuntary/s\n",
+                   static_cast<double>(summary.voluntarySwitches) / summary.seconds,
+                   static_cast<double>(summary.involuntarySwitches) / summary.seconds);
+    if (summary.totalTicks)
+        META_CONPRINTF("Host CPU steal: %.2f%%\n", 100.0 * summary.stealTicks / summary.totalTicks);
+
+    META_CONPRINTF("Run queue wait per tick:\n");
+    uint64_t lowerUs = 0;
+    for (size_t i = 0; i < SchedSummary::kBuckets; ++i) {
+        const uint64_t limitUs = SchedStats::BucketLimitUs(i);
+        const double share = 100.0 * summary.buckets[i] / summary.ticks;
+        if (limitUs)
+            META_CONPRINTF("  %6llu - %6llu us: %8llu  %5.1f%%\n", static_cast<unsigned long long>(lowerUs),
+                           static_cast<unsigned long long>(limitUs), static_cast<unsigned long long>(summary.buckets[i]),
+                           share);
+        else
+            META_CONPRINTF("  %6llu us and up:  %8llu  %5.1f%%\n", static_cast<unsigned long long>(lowerUs),
+                           static_cast<unsigned long long>(summary.buckets[i]), share);
+        lowerUs = limitUs;
+    }
+}
+
+CON_COMMAND_F(acc_trace_overhead, "Prints the current trace level and what tracing cost per second. "
+                                  "Usage: acc_trace_overhead [seconds]", FCVAR_NONE) {
+    int seconds = 10;
+    if (args.ArgC() > 1)
+        seconds = std::clamp(std::atoi(args[1]), 1, static_cast<int>(TraceGovernor::kHistorySeconds));
+
+    META_CONPRINTF("Trace level: %s\n", TraceGovernor::LevelName(TraceGovernor::Level()));
+
+    TraceOverheadSecond history[TraceGovernor::kHistorySeconds];
+    const size_t count = TraceGovernor::Recent(history, static_cast<size_t>(seconds));
+    if (count == 0) {
+        META_CONPRINTF("No overhead history yet.\n");
+        return;
+    }
+
+    META_CONPRINTF("-------- TRACE OVERHEAD, NEWEST SECOND FIRST --------\n");
+    META_CONPRINTF("%6s  %10s  %10s  %8s  %8s  %s\n", "ticks", "managed ms", "native ms", "share", "max tick",
+                   "level");
+    for (size_t i = 0; i < count; ++i) {
+        const TraceOverheadSecond &second = history[i];
+        const uint64_t overheadNs = std::max(second.managedNs, second.nativeNs);
+        META_CONPRINTF("%6llu  %10.3f  %10.3f  %7.2f%%  %7.2f%%  %s\n", static_cast<unsigned long long>(second.ticks),
+                       static_cast<double>(second.managedNs) / 1e6, static_cast<double>(second.nativeNs) / 1e6,
+                       second.frameNs ? 100.0 * overheadNs / second.frameNs : 0.0, 100.0 * second.maxTickShare,
+                       TraceGovernor::LevelName(second.level));
+    }
+}
+
+CON_COMMAND_F(acc_net, "Prints the outgoing net/user messages of the last second by bytes sent. Usage: acc_net [count]",
+              FCVAR_NONE) {
+    size_t count = 15;
+    if (args.ArgC() > 1)
+        count = std::clamp(std::atoi(args[1]), 1, static_cast<int>(NetMessageTrace::kMaxMessageId));
+
+    NetMessageRate rates[NetMessageTrace::kMaxMessageId];
+    const size_t found = NetMessageTrace::LastSecond(rates, count);
+
+    META_CONPRINTF("-------- NET MESSAGES LAST SECOND (bytes x recipients) --------\n");
+    for (size_t i = 0; i < found; ++i) {
+        META_CONPRINTF("%10.1f KB %6u msgs  %s (%u)\n", static_cast<double>(rates[i].bytes) / 1024, rates[i].count,
+                       NetMessageTrace::Name(rates[i].messageId), rates[i].messageId);
+    }
+    if (found == 0)
+        META_CONPRINTF("Nothing recorded, is NetMessageTraceEnabled set in config.json?\n");
+}
+
+CON_COMMAND_F(acc_top_events, "Prints the most fired game events in the last second and since load. Usage: acc_top_events [count]",
+              FCVAR_NONE) {
+    size_t count = 10;
+    if (args.ArgC() > 1)
+        count = std::clamp(std::atoi(args[1]), 1, static_cast<int>(GameEventTrace::kMaxEventTypes));
+
+    GameEventRate rates[GameEventTrace::kMaxEventTypes];
+
+    size_t found = GameEventTrace::LastSecond(rates, count);
+    META_CONPRINTF("-------- TOP GAME EVENTS LAST SECOND --------\n");
+    for (size_t i = 0; i < found; ++i)
+        META_CONPRINTF("%3zu. %10llu  %s\n", i + 1, static_cast<unsigned long long>(rates[i].fires),
+                       NameTable::Get(rates[i].nameId));
+
+    found = GameEventTrace::Totals(rates, count);
+    META_CONPRINTF("-------- TOP GAME EVENTS SINCE LOAD --------\n");
+    for (size_t i = 0; i < found; ++i)
+        META_CONPRINTF("%3zu. %10llu  %s\n", i + 1, static_cast<unsigned long long>(rates[i].fires),
+                       NameTable::Get(rates[i].nameId));
+
+    if (found == 0)
+        META_CONPRINTF("Nothing recorded, is GameEventTraceEnabled set in config.json?\n");
+}
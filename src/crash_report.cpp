@@ -0,0 +1,567 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "crash_report.h"
+#include "callback_stack.h"
+#include "callback_stats.h"
+#include "callback_trace.h"
+#include "crash_writer.h"
+#include "entity_snapshot.h"
+#include "exception_trace.h"
+#include "game_event_trace.h"
+#include "memory_tracker.h"
+#include "names.h"
+#include "net_trace.h"
+#include "tick_stats.h"
+#include "timing.h"
+#include "trace_governor.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr uint32_t kSummarySeconds = 5;
+        constexpr size_t kSummaryTop = 20;
+        constexpr size_t kExceptionSeconds = 10;
+        constexpr size_t kTicks = 64;
+        constexpr size_t kPlugins = 10;
+        constexpr size_t kNetTypes = 10;
+        constexpr size_t kNetMessages = 32;
+        constexpr size_t kEventTypes = 10;
+        constexpr size_t kEvents = 32;
+        constexpr uint64_t kMemoryWindowNs = 5ull * 60 * 1000000000;
+
+        // Scratch space for the crash handler, the heap may not be usable by the time it runs.
+        CallbackTraceRecord g_Record;
+        char g_Frame[1024];
+        char g_Args[4096];
+        size_t g_Timeline[CallbackTrace::kMaxCapacity];
+        ExceptionRecord g_Exceptions[ExceptionTrace::kCapacity];
+        TickSample g_Ticks[kTicks];
+        NetMessageRecord g_NetMessages[kNetMessages];
+        GameEventRecord g_Events[kEvents];
+        MemorySample g_Memory[CrashReport::kMemorySamples];
+
+        // Lists every file mapped at offset 0 from /proc/self/maps, read with raw syscalls into stack buffers.
+        void WriteModuleList(CrashWriter &writer) {
+            int fd = open("/proc/self/maps", O_RDONLY);
+            if (fd < 0)
+                return;
+
+            char chunk[4096];
+            char line[PATH_MAX + 128];
+            char lastPath[PATH_MAX] = "";
+            size_t lineLen = 0;
+            bool first = true;
+
+            auto handleLine = [&]() {
+                line[lineLen] = '\0';
+
+                unsigned long start = 0, end = 0, offset = 0;
+                int pathPos = -1;
+                if (sscanf(line, "%lx-%lx %*4s %lx %*s %*s %n", &start, &end, &offset, &pathPos) < 3 || pathPos < 0)
+                    return;
+
+                const char *path = line + pathPos;
+                if (offset != 0 || path[0] != '/' || strcmp(path, lastPath) == 0)
+                    return;
+
+                strncpy(lastPath, path, sizeof(lastPath) - 1);
+
+                writer.Write(first ? "\n    {\"path\": " : ",\n    {\"path\": ");
+                writer.JsonString(path);
+                writer.Printf(", \"base\": \"0x%lx\"}", start);
+                first = false;
+            };
+
+            ssize_t bytes;
+            while ((bytes = read(fd, chunk, sizeof(chunk))) > 0) {
+                for (ssize_t i = 0; i < bytes; ++i) {
+                    if (chunk[i] == '\n') {
+                        handleLine();
+                        lineLen = 0;
+                    } else if (lineLen < sizeof(line) - 1) {
+                        line[lineLen++] = chunk[i];
+                    }
+                }
+            }
+            if (lineLen > 0)
+                handleLine();
+
+            close(fd);
+        }
+    }
+
+    // Machine-readable sidecar of the .txt report, so fleet tooling does not have to parse the text sections.
+    bool CrashReport::WriteJson(const char *path, const char *minidumpPath, const CrashContext &context,
+                               const CrashTiming &timing) {
+        CrashWriter writer(path);
+        if (!writer.IsOpen())
+            return false;
+
+        writer.Write("{\n  \"version\": ");
+        writer.JsonString(context.version);
+        writer.Write(",\n  \"minidump\": ");
+        writer.JsonString(minidumpPath);
+        writer.Write(",\n  \"map\": ");
+        writer.JsonString(context.map);
+        writer.Write(",\n  \"gamePath\": ");
+        writer.JsonString(context.gamePath);
+        writer.Write(",\n  \"commandLine\": ");
+        writer.JsonString(context.commandLine);
+        writer.Write(",\n  \"traceLevel\": ");
+        writer.JsonString(TraceGovernor::LevelName(TraceGovernor::Level()));
+        writer.Printf(",\n  \"crashHandler\": {\"minidumpNs\": %llu, \"minidumpBytes\": %llu, \"textReportNs\": %llu, "
+                      "\"textReportBytes\": %llu}",
+                      static_cast<unsigned long long>(timing.minidumpNs),
+                      static_cast<unsigned long long>(timing.minidumpBytes),
+                      static_cast<unsigned long long>(timing.textNs),
+                      static_cast<unsigned long long>(timing.textBytes));
+        writer.Write(",\n  \"consoleHistory\": ");
+        writer.JsonString(context.consoleHistory);
+
+        writer.Printf(",\n  \"callbackSummary\": {\n    \"windowSeconds\": %u,\n    \"top\": [", kSummarySeconds);
+        {
+            CallbackRate top[kSummaryTop];
+            const size_t found = CallbackStats::RecentForCrash(kSummarySeconds, top, kSummaryTop);
+
+            for (size_t i = 0; i < found; ++i) {
+                writer.Write(i ? ",\n      {\"name\": " : "\n      {\"name\": ");
+                writer.JsonString(NameTable::Get(top[i].methodId));
+                writer.Printf(", \"calls\": %llu}", static_cast<unsigned long long>(top[i].calls));
+            }
+
+            writer.Write("\n    ],\n    \"longestRunning\": ");
+            OpenCallback oldest{};
+            if (CallbackStack::Oldest(oldest)) {
+                writer.Write("{\"name\": ");
+                writer.JsonString(NameTable::Get(oldest.methodId));
+                writer.Printf(", \"runningNs\": %llu, \"thread\": %d, \"depth\": %u}",
+                              static_cast<unsigned long long>(MonotonicNs() - oldest.enterNs),
+                              oldest.tid, oldest.depth);
+            } else {
+                writer.Write("null");
+            }
+        }
+        {
+            const GcSnapshot &gc = TickStats::LatestGc();
+            writer.Printf("\n  },\n  \"gc\": {\"gen0Collections\": %u, \"gen1Collections\": %u, "
+                          "\"gen2Collections\": %u, \"heapSizeBytes\": %llu, \"fragmentedBytes\": %llu, "
+                          "\"allocatedBytes\": %llu, \"totalPauseNs\": %llu, \"lastPauseNs\": %llu, "
+                          "\"lastPauseGeneration\": %u},\n  \"pluginAllocations\": [",
+                          gc.gen0Collections, gc.gen1Collections, gc.gen2Collections,
+                          static_cast<unsigned long long>(gc.heapSizeBytes),
+                          static_cast<unsigned long long>(gc.fragmentedBytes),
+                          static_cast<unsigned long long>(gc.allocatedBytes),
+                          static_cast<unsigned long long>(gc.totalPauseNs),
+                          static_cast<unsigned long long>(gc.lastPauseNs), gc.lastPauseGeneration);
+
+            PluginAllocationRate plugins[kPlugins];
+            const size_t pluginCount = TickStats::PluginRates(plugins, kPlugins);
+            for (size_t i = 0; i < pluginCount; ++i) {
+                writer.Write(i ? ",\n    {\"plugin\": " : "\n    {\"plugin\": ");
+                writer.JsonString(NameTable::Get(plugins[i].nameId));
+                writer.Printf(", \"bytesPerSec\": %llu}", static_cast<unsigned long long>(plugins[i].bytesPerSec));
+            }
+
+            writer.Write("\n  ],\n  \"ticks\": [");
+            const size_t ticks = TickStats::Recent(g_Ticks, kTicks);
+            for (size_t i = 0; i < ticks; ++i) {
+                const TickSample &sample = g_Ticks[i];
+                writer.Printf("%s\n    {\"tick\": %llu, \"durationNs\": %llu, \"gen0Collections\": %u, "
+                              "\"gen1Collections\": %u, \"gen2Collections\": %u, \"totalPauseNs\": %llu, "
+                              "\"cpuNs\": %llu, \"runDelayNs\": %llu, \"voluntarySwitches\": %u, "
+                              "\"involuntarySwitches\": %u}", i ? "," : "",
+                              static_cast<unsigned long long>(sample.tick),
+                              static_cast<unsigned long long>(sample.durationNs),
+                              sample.gc.gen0Collections, sample.gc.gen1Collections, sample.gc.gen2Collections,
+                              static_cast<unsigned long long>(sample.gc.totalPauseNs),
+                              static_cast<unsigned long long>(sample.sched.cpuNs),
+                              static_cast<unsigned long long>(sample.sched.runDelayNs), sample.sched.voluntarySwitches,
+                              sample.sched.involuntarySwitches);
+            }
+            writer.Write("\n  ],\n  \"netMessages\": {\n    \"lastSecond\": [");
+        }
+        {
+            NetMessageRate rates[kNetTypes];
+            const size_t types = NetMessageTrace::LastSecond(rates, kNetTypes);
+            for (size_t i = 0; i < types; ++i) {
+                writer.Write(i ? ",\n      {\"name\": " : "\n      {\"name\": ");
+                writer.JsonString(NetMessageTrace::Name(rates[i].messageId));
+                writer.Printf(", \"id\": %u, \"count\": %u, \"bytes\": %llu}", rates[i].messageId, rates[i].count,
+                              static_cast<unsigned long long>(rates[i].bytes));
+            }
+
+            writer.Write("\n    ],\n    \"recent\": [");
+            const size_t count = NetMessageTrace::Recent(g_NetMessages, kNetMessages);
+            for (size_t i = 0; i < count; ++i) {
+                const NetMessageRecord &record = g_NetMessages[i];
+                writer.Write(i ? ",\n      {\"name\": " : "\n      {\"name\": ");
+                writer.JsonString(NetMessageTrace::Name(record.messageId));
+                writer.Printf(", \"id\": %u, \"tick\": %llu, \"bytes\": %u, \"recipients\": %u}", record.messageId,
+                              static_cast<unsigned long long>(record.tick), record.bytes, record.recipients);
+            }
+            writer.Write("\n    ]\n  },\n  \"memory\": [");
+        }
+        {
+            const uint64_t crashNs = MonotonicNs();
+            const size_t count = MemoryTracker::Recent(g_Memory, kMemorySamples);
+            for (size_t i = 0; i < count; ++i) {
+                const MemorySample &sample = g_Memory[i];
+                if (crashNs - sample.timestampNs > kMemoryWindowNs)
+                    break;
+
+                writer.Printf("%s\n    {\"agoNs\": %llu, \"tick\": %llu, \"rssBytes\": %llu, \"pssBytes\": %llu, "
+                              "\"anonymousBytes\": %llu, \"managedHeapBytes\": %llu}", i ? "," : "",
+                              static_cast<unsigned long long>(crashNs - sample.timestampNs),
+                              static_cast<unsigned long long>(sample.tick),
+                              static_cast<unsigned long long>(sample.rssBytes),
+                              static_cast<unsigned long long>(sample.pssBytes),
+                              static_cast<unsigned long long>(sample.anonymousBytes),
+                              static_cast<unsigned long long>(sample.managedHeapBytes));
+            }
+            writer.Write("\n  ],\n  \"entities\": ");
+        }
+        if (const EntitySummary *entities = EntitySnapshot::Latest()) {
+            writer.Printf("{\"tick\": %llu, \"ageNs\": %llu, \"total\": %u, \"highestIndex\": %d, "
+                          "\"classes\": %u, \"top\": [",
+                          static_cast<unsigned long long>(entities->tick),
+                          static_cast<unsigned long long>(MonotonicNs() - entities->timestampNs),
+                          entities->total, entities->highestIndex, entities->classCount);
+            for (uint32_t i = 0; i < entities->topCount; ++i) {
+                writer.Write(i ? ",\n    {\"classname\": " : "\n    {\"classname\": ");
+                writer.JsonString(entities->top[i].classname);
+                writer.Printf(", \"count\": %u}", entities->top[i].count);
+            }
+            writer.Write("\n  ]}");
+        } else {
+            writer.Write("null");
+        }
+        writer.Write(",\n  \"gameEvents\": {\n    \"lastSecond\": [");
+        {
+            GameEventRate rates[kEventTypes];
+            const size_t types = GameEventTrace::LastSecond(rates, kEventTypes);
+            for (size_t i = 0; i < types; ++i) {
+                writer.Write(i ? ",\n      {\"name\": " : "\n      {\"name\": ");
+                writer.JsonString(NameTable::Get(rates[i].nameId));
+                writer.Printf(", \"fires\": %llu}", static_cast<unsigned long long>(rates[i].fires));
+            }
+
+            writer.Write("\n    ],\n    \"recent\": [");
+            const size_t count = GameEventTrace::Recent(g_Events, kEvents);
+            for (size_t i = 0; i < count; ++i) {
+                writer.Write(i ? ",\n      {\"name\": " : "\n      {\"name\": ");
+                writer.JsonString(NameTable::Get(g_Events[i].nameId));
+                writer.Printf(", \"tick\": %llu}", static_cast<unsigned long long>(g_Events[i].tick));
+            }
+            writer.Write("\n    ]\n  },\n  \"firstChanceExceptions\": {\n    \"perSecond\": [");
+        }
+        {
+            uint32_t perSecond[kExceptionSeconds];
+            const size_t seconds = ExceptionTrace::PerSecond(perSecond, std::size(perSecond));
+            writer.Printf("%u", ExceptionTrace::CurrentSecond());
+            for (size_t i = 0; i < seconds; ++i)
+                writer.Printf(", %u", perSecond[i]);
+
+            writer.Write("],\n    \"recent\": [");
+            const uint64_t crashNs = MonotonicNs();
+            const size_t count = ExceptionTrace::Recent(g_Exceptions, std::size(g_Exceptions));
+            for (size_t i = 0; i < count; ++i) {
+                const ExceptionRecord &record = g_Exceptions[i];
+                writer.Write(i ? ",\n      {\"type\": " : "\n      {\"type\": ");
+                writer.JsonString(NameTable::Get(record.typeId));
+                writer.Write(", \"method\": ");
+                writer.JsonString(NameTable::Get(record.methodId));
+                writer.Printf(", \"hresult\": %d, \"agoNs\": %lld, \"tick\": %llu, \"thread\": %d, "
+                              "\"managedThread\": %d}",
+                              record.hresult, static_cast<long long>(crashNs - record.timestampNs),
+                              static_cast<unsigned long long>(record.tick), record.tid, record.managedTid);
+            }
+            writer.Write("\n    ]");
+        }
+        writer.Printf("\n  },\n  \"crashThread\": %d,\n  \"gameThread\": %d,\n  \"crashTick\": %llu,"
+                      "\n  \"callbackTrace\": [",
+                      CurrentThreadId(), g_GameThreadId.load(), static_cast<unsigned long long>(g_ServerTick.load()));
+        {
+            const uint64_t crashNs = MonotonicNs();
+            const size_t count = CallbackTrace::Timeline(g_Timeline, std::size(g_Timeline));
+            bool first = true;
+
+            for (size_t i = 0; i < count; ++i) {
+                if (!CallbackTrace::Read(g_Timeline[i], g_Record))
+                    continue;
+
+                const CallbackTraceRecord &record = g_Record;
+                writer.Write(first ? "\n    {\"name\": " : ",\n    {\"name\": ");
+                writer.JsonString(NameTable::Get(record.methodId));
+                writer.Printf(", \"timestampNs\": %llu, \"agoNs\": %lld, \"tick\": %llu, \"thread\": %d, "
+                              "\"managedThread\": %d",
+                              static_cast<unsigned long long>(record.timestampNs),
+                              static_cast<long long>(crashNs - record.timestampNs),
+                              static_cast<unsigned long long>(record.tick), record.tid, record.managedTid);
+                writer.Write(", \"args\": ");
+                writer.JsonString(g_Args, CallbackTrace::FormatArgs(record, g_Args, sizeof(g_Args)));
+                writer.Write(", \"stack\": [");
+                for (size_t frame = 0; frame < record.frameCount; ++frame) {
+                    const size_t len = CallbackTrace::FormatFrame(record.frames[frame], g_Frame, sizeof(g_Frame));
+                    if (frame)
+                        writer.Write(", ");
+                    writer.JsonString(g_Frame, len);
+                }
+                writer.Write("]}");
+                first = false;
+            }
+        }
+        writer.Write("\n  ],\n  \"modules\": [");
+        WriteModuleList(writer);
+        writer.Write("\n  ]\n}\n");
+
+        return true;
+    }
+
+    bool CrashReport::WriteText(const char *path, const CrashContext &context, CrashTiming &timing) {
+        const uint64_t startNs = MonotonicNs();
+        CrashWriter writer(path);
+        if (!writer.IsOpen())
+            return false;
+
+        writer.Write("-------- CONFIG BEGIN --------\n");
+        writer.Printf("Map=%s\n", context.map);
+        writer.Printf("GamePath=%s\n", context.gamePath);
+        writer.Printf("CommandLine=%s\n", context.commandLine);
+        writer.Printf("TraceLevel=%s\n", TraceGovernor::LevelName(TraceGovernor::Level()));
+        writer.Write("-------- CONFIG END --------\n\n");
+
+        if (context.consoleHistory && context.consoleHistory[0]) {
+            writer.Write("-------- CONSOLE HISTORY BEGIN --------\n");
+            writer.Write(context.consoleHistory);
+            writer.Write("-------- CONSOLE HISTORY END --------\n\n");
+        }
+
+        writer.Write("-------- CALLBACK SUMMARY BEGIN --------\n");
+        {
+            CallbackRate top[kSummaryTop];
+            const size_t found = CallbackStats::RecentForCrash(kSummarySeconds, top, kSummaryTop);
+
+            writer.Printf("Top callbacks in the last %us (calls):\n", kSummarySeconds);
+            for (size_t i = 0; i < found; ++i)
+                writer.Printf("%10llu  %s\n", static_cast<unsigned long long>(top[i].calls),
+                              NameTable::Get(top[i].methodId));
+
+            OpenCallback oldest{};
+            if (CallbackStack::Oldest(oldest))
+                writer.Printf("Longest running callback still on the stack: %s (%.3f ms, thread %d, depth %u)\n",
+                              NameTable::Get(oldest.methodId),
+                              static_cast<double>(MonotonicNs() - oldest.enterNs) / 1e6, oldest.tid,
+                              oldest.depth);
+        }
+        writer.Write("-------- CALLBACK SUMMARY END --------\n\n");
+
+        writer.Write("-------- GC AND TICKS BEGIN -> NEWEST TICK IS FIRST --------\n");
+        {
+            const GcSnapshot &gc = TickStats::LatestGc();
+            writer.Printf("Collections gen0/1/2: %u/%u/%u, heap %llu MB (fragmented %llu MB), allocated %llu MB, "
+                          "total pause %.3f ms, last pause %.3f ms (gen%u)\n",
+                          gc.gen0Collections, gc.gen1Collections, gc.gen2Collections,
+                          static_cast<unsigned long long>(gc.heapSizeBytes / (1024 * 1024)),
+                          static_cast<unsigned long long>(gc.fragmentedBytes / (1024 * 1024)),
+                          static_cast<unsigned long long>(gc.allocatedBytes / (1024 * 1024)),
+                          static_cast<double>(gc.totalPauseNs) / 1e6, static_cast<double>(gc.lastPauseNs) / 1e6,
+                          gc.lastPauseGeneration);
+
+            PluginAllocationRate plugins[kPlugins];
+            const size_t pluginCount = TickStats::PluginRates(plugins, kPlugins);
+            for (size_t i = 0; i < pluginCount; ++i)
+                writer.Printf("Allocation rate %10llu KB/s  %s\n",
+                              static_cast<unsigned long long>(plugins[i].bytesPerSec / 1024),
+                              NameTable::Get(plugins[i].nameId));
+
+            const size_t ticks = TickStats::Recent(g_Ticks, kTicks);
+            for (size_t i = 0; i < ticks; ++i) {
+                const TickSample &sample = g_Ticks[i];
+                const GcSnapshot &before = i + 1 < ticks ? g_Ticks[i + 1].gc : sample.gc;
+                writer.Printf("tick %llu: %.3f ms, GC +%u/+%u/+%u, pause +%.3f ms, run queue wait %.3f ms, "
+                              "%u involuntary switches\n",
+                              static_cast<unsigned long long>(sample.tick),
+                              static_cast<double>(sample.durationNs) / 1e6,
+                              sample.gc.gen0Collections - before.gen0Collections,
+                              sample.gc.gen1Collections - before.gen1Collections,
+                              sample.gc.gen2Collections - before.gen2Collections,
+                              static_cast<double>(sample.gc.totalPauseNs - before.totalPauseNs) / 1e6,
+                              static_cast<double>(sample.sched.runDelayNs) / 1e6, sample.sched.involuntarySwitches);
+            }
+        }
+        writer.Write("-------- GC AND TICKS END --------\n\n");
+
+        writer.Write("-------- NET MESSAGES BEGIN -> NEWEST IS FIRST --------\n");
+        {
+            NetMessageRate rates[kNetTypes];
+            const size_t types = NetMessageTrace::LastSecond(rates, kNetTypes);
+            writer.Write("Last second by bytes sent:\n");
+            for (size_t i = 0; i < types; ++i)
+                writer.Printf("%10llu B %6llux  %s\n", static_cast<unsigned long long>(rates[i].bytes),
+                              static_cast<unsigned long long>(rates[i].count),
+                              NetMessageTrace::Name(rates[i].messageId));
+
+            const size_t count = NetMessageTrace::Recent(g_NetMessages, kNetMessages);
+            for (size_t i = 0; i < count; ++i) {
+                const NetMessageRecord &record = g_NetMessages[i];
+                writer.Printf("tick %llu: %s (%u), %u B to %u clients\n",
+                              static_cast<unsigned long long>(record.tick), NetMessageTrace::Name(record.messageId),
+                              record.messageId, record.bytes, record.recipients);
+            }
+        }
+        writer.Write("-------- NET MESSAGES END --------\n\n");
+
+        writer.Write("-------- MEMORY HISTORY BEGIN -> NEWEST IS FIRST --------\n");
+        {
+            const uint64_t crashNs = MonotonicNs();
+            const size_t count = MemoryTracker::Recent(g_Memory, kMemorySamples);
+            for (size_t i = 0; i < count; ++i) {
+                const MemorySample &sample = g_Memory[i];
+                if (crashNs - sample.timestampNs > kMemoryWindowNs)
+                    break;
+
+                writer.Printf("[-%.0f s] tick %llu: RSS %llu MB, PSS %llu MB, anonymous %llu MB, "
+                              "managed heap %llu MB\n",
+                              static_cast<double>(crashNs - sample.timestampNs) / 1e9,
+                              static_cast<unsigned long long>(sample.tick),
+                              static_cast<unsigned long long>(sample.rssBytes / (1024 * 1024)),
+                              static_cast<unsigned long long>(sample.pssBytes / (1024 * 1024)),
+                              static_cast<unsigned long long>(sample.anonymousBytes / (1024 * 1024)),
+                              static_cast<unsigned long long>(sample.managedHeapBytes / (1024 * 1024)));
+            }
+        }
+        writer.Write("-------- MEMORY HISTORY END --------\n\n");
+
+        writer.Write("-------- ENTITIES BEGIN --------\n");
+        if (const EntitySummary *entities = EntitySnapshot::Latest()) {
+            writer.Printf("Snapshot from tick %llu (%.1f s before the crash)\n",
+                          static_cast<unsigned long long>(entities->tick),
+                          static_cast<double>(MonotonicNs() - entities->timestampNs) / 1e9);
+            writer.Printf("Entities: %u, highest index: %d, classes: %u\n", entities->total, entities->highestIndex,
+                          entities->classCount);
+            for (uint32_t i = 0; i < entities->topCount; ++i)
+                writer.Printf("%10u  %s\n", entities->top[i].count, entities->top[i].classname);
+        } else {
+            writer.Write("No entity snapshot was taken.\n");
+        }
+        writer.Write("-------- ENTITIES END --------\n\n");
+
+        writer.Write("-------- GAME EVENTS BEGIN -> NEWEST IS FIRST --------\n");
+        {
+            GameEventRate rates[kEventTypes];
+            const size_t types = GameEventTrace::LastSecond(rates, kEventTypes);
+            writer.Write("Last second by fires:\n");
+            for (size_t i = 0; i < types; ++i)
+                writer.Printf("%10llu  %s\n", static_cast<unsigned long long>(rates[i].fires),
+                              NameTable::Get(rates[i].nameId));
+
+            const size_t count = GameEventTrace::Recent(g_Events, kEvents);
+            for (size_t i = 0; i < count; ++i)
+                writer.Printf("tick %llu: %s\n", static_cast<unsigned long long>(g_Events[i].tick),
+                              NameTable::Get(g_Events[i].nameId));
+        }
+        writer.Write("-------- GAME EVENTS END --------\n\n");
+
+        writer.Write("-------- FIRST-CHANCE EXCEPTIONS BEGIN -> NEWEST IS FIRST --------\n");
+        {
+            uint32_t perSecond[kExceptionSeconds];
+            const size_t seconds = ExceptionTrace::PerSecond(perSecond, std::size(perSecond));
+
+            writer.Printf("Per second (current first): %u", ExceptionTrace::CurrentSecond());
+            for (size_t i = 0; i < seconds; ++i)
+                writer.Printf(" %u", perSecond[i]);
+            writer.Write("\n");
+
+            const uint64_t crashNs = MonotonicNs();
+            const size_t count = ExceptionTrace::Recent(g_Exceptions, std::size(g_Exceptions));
+            for (size_t i = 0; i < count; ++i) {
+                const ExceptionRecord &record = g_Exceptions[i];
+                writer.Printf("[-%.3f ms] tick %llu, thread %d (managed %d) %s (0x%x) in %s\n",
+                              static_cast<double>(static_cast<int64_t>(crashNs - record.timestampNs)) / 1e6,
+                              static_cast<unsigned long long>(record.tick), record.tid, record.managedTid,
+                              NameTable::Get(record.typeId), static_cast<uint32_t>(record.hresult),
+                              NameTable::Get(record.methodId));
+            }
+        }
+        writer.Write("-------- FIRST-CHANCE EXCEPTIONS END --------\n\n");
+
+        writer.Write("-------- CALLBACK TRACE BEGIN -> NEWEST CALLBACK IS FIRST --------\n");
+        {
+            const int crashTid = CurrentThreadId();
+            const uint64_t crashNs = MonotonicNs();
+
+            writer.Printf("Crashing thread: %d, game thread: %d, tick: %llu\n", crashTid,
+                          g_GameThreadId.load(),
+                          static_cast<unsigned long long>(g_ServerTick.load()));
+            writer.Write("Callbacks issued by the crashing thread are marked with >>\n");
+            writer.Write("-----------------------------\n");
+
+            const size_t count = CallbackTrace::Timeline(g_Timeline, std::size(g_Timeline));
+            for (size_t i = 0; i < count; ++i) {
+                if (!CallbackTrace::Read(g_Timeline[i], g_Record))
+                    continue;
+
+                const CallbackTraceRecord &record = g_Record;
+                writer.Printf("%s[-%.3f ms] tick %llu, thread %d (managed %d)\n",
+                              record.tid == crashTid ? ">> " : "   ",
+                              static_cast<double>(static_cast<int64_t>(crashNs - record.timestampNs)) / 1e6,
+                              static_cast<unsigned long long>(record.tick), record.tid, record.managedTid);
+                writer.Write("Name: ");
+                writer.Write(NameTable::Get(record.methodId));
+                writer.Write("\n");
+                if (record.argsLen) {
+                    writer.Write("Args: ");
+                    writer.Write(g_Args, CallbackTrace::FormatArgs(record, g_Args, sizeof(g_Args)));
+                    writer.Write("\n");
+                }
+                if (record.frameCount)
+                    writer.Write("Stack:\n");
+                for (size_t frame = 0; frame < record.frameCount; ++frame) {
+                    writer.Write("   at ");
+                    writer.Write(g_Frame, CallbackTrace::FormatFrame(record.frames[frame], g_Frame, sizeof(g_Frame)));
+                    writer.Write("\n");
+                }
+                writer.Write("-----------------------------\n");
+            }
+        }
+        writer.Write("-------- CALLBACK TRACE END --------\n\n");
+
+        // Covers everything above, the section itself is only a few dozen bytes.
+        timing.textNs = MonotonicNs() - startNs;
+        timing.textBytes = writer.BytesWritten();
+        writer.Write("-------- CRASH HANDLER BEGIN --------\n");
+        writer.Printf("Minidump: %.3f ms, %llu bytes\n", static_cast<double>(timing.minidumpNs) / 1e6,
+                      static_cast<unsigned long long>(timing.minidumpBytes));
+        writer.Printf("This report: %.3f ms, %llu bytes\n", static_cast<double>(timing.textNs) / 1e6,
+                      static_cast<unsigned long long>(timing.textBytes));
+        writer.Write("-------- CRASH HANDLER END --------\n");
+        return true;
+    }
+
+    void CrashReport::Write(const char *minidumpPath, const CrashContext &context, uint64_t startNs,
+                            CrashReportFiles &out) {
+        out = {};
+        out.timing.minidumpNs = startNs ? MonotonicNs() - startNs : 0;
+        struct stat minidumpStat{};
+        if (stat(minidumpPath, &minidumpStat) == 0)
+            out.timing.minidumpBytes = static_cast<uint64_t>(minidumpStat.st_size);
+
+        snprintf(out.textPath, sizeof(out.textPath), "%s.txt", minidumpPath);
+        snprintf(out.jsonPath, sizeof(out.jsonPath), "%s.json", minidumpPath);
+
+        out.textWritten = WriteText(out.textPath, context, out.timing);
+
+        const uint64_t jsonStartNs = MonotonicNs();
+        out.jsonWritten = WriteJson(out.jsonPath, minidumpPath, context, out.timing);
+        out.jsonNs = MonotonicNs() - jsonStartNs;
+    }
+}
@@ -0,0 +1,54 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct CrashTiming {
+        uint64_t minidumpNs;
+        uint64_t minidumpBytes;
+        uint64_t textNs;
+        uint64_t textBytes;
+    };
+
+    // Process state captured before the crash, the strings must live in static storage.
+    struct CrashContext {
+        const char *version;
+        const char *map;
+        const char *gamePath;
+        const char *commandLine;
+        const char *consoleHistory;
+    };
+
+    struct CrashReportFiles {
+        char textPath[512];
+        char jsonPath[512];
+        bool textWritten;
+        bool jsonWritten;
+        uint64_t jsonNs;
+        CrashTiming timing;
+    };
+
+    // The .txt and .json reports written next to a crash minidump from inside the crash handler, so they only go
+    // through CrashWriter and static scratch buffers. Only the SDK-free trace modules are read, which lets crash_test
+    // drive the writers without a server.
+    class CrashReport {
+    public:
+        // Memory samples read back for the report, the last few minutes at the default interval.
+        static constexpr size_t kMemorySamples = 64;
+
+        // Writes <minidumpPath>.txt and <minidumpPath>.json. startNs is when the handler started, the minidump is
+        // written in between.
+        static void Write(const char *minidumpPath, const CrashContext &context, uint64_t startNs,
+                          CrashReportFiles &out);
+
+        static bool WriteText(const char *path, const CrashContext &context, CrashTiming &timing);
+
+        static bool WriteJson(const char *path, const char *minidumpPath, const CrashContext &context,
+                              const CrashTiming &timing);
+    };
+}
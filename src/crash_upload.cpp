@@ -0,0 +1,249 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "crash_upload.h"
+#include "helper_threads.h"
+#include "log.h"
+
+#include "common/linux/http_upload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <dlfcn.h>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace acceleratorcss {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // Breakpad's HTTPUpload sets no curl timeouts, so Stop only waits this long for an upload in flight.
+        constexpr auto kStopTimeout = std::chrono::seconds(5);
+
+        struct PendingDump {
+            std::string path;
+            int attempts = 0;
+            Clock::time_point notBefore;
+        };
+
+        CrashUploadConfig g_Config;
+        std::mutex g_Mutex;
+        std::condition_variable g_Wake;
+        std::deque<PendingDump> g_Queue;
+        std::vector<std::thread> g_Workers;
+        bool g_Stopping = false;
+        size_t g_InFlight = 0;
+        // Worker threads that have not returned yet, including ones Stop gave up on and detached.
+        size_t g_Running = 0;
+        std::condition_variable g_Exited;
+
+        // Shared across workers, the next moment an upload may start without exceeding the bandwidth budget.
+        Clock::time_point g_NextSlot;
+
+        std::string Sidecar(const std::string &dump, const char *suffix) { return dump + suffix; }
+
+        uintmax_t FileSize(const std::string &path) {
+            std::error_code ec;
+            const uintmax_t size = fs::file_size(path, ec);
+            return ec ? 0 : size;
+        }
+
+        std::string HostName() {
+            char name[256] = {};
+            if (gethostname(name, sizeof(name) - 1) != 0)
+                return "unknown";
+            return name;
+        }
+
+        bool Upload(const std::string &dump, std::string &error) {
+            std::map<std::string, std::string> parameters{
+                {"host", HostName()},
+                {"dump", fs::path(dump).filename().string()},
+            };
+            std::map<std::string, std::string> files{{"upload_file_minidump", dump}};
+            if (fs::exists(Sidecar(dump, ".txt")))
+                files.emplace("report_txt", Sidecar(dump, ".txt"));
+            if (fs::exists(Sidecar(dump, ".json")))
+                files.emplace("report_json", Sidecar(dump, ".json"));
+
+            std::string response;
+            long responseCode = 0;
+            if (!google_breakpad::HTTPUpload::SendRequest(g_Config.url, parameters, files, "", "", "", &response,
+                                                          &responseCode, &error))
+                return false;
+
+            if (responseCode < 200 || responseCode >= 300) {
+                error = "HTTP " + std::to_string(responseCode);
+                return false;
+            }
+            return true;
+        }
+
+        void ApplyRetention(const std::string &dump) {
+            std::error_code ec;
+            if (g_Config.retention == UploadRetention::Delete) {
+                fs::remove(dump, ec);
+                fs::remove(Sidecar(dump, ".txt"), ec);
+                fs::remove(Sidecar(dump, ".json"), ec);
+                return;
+            }
+
+            FILE *marker = std::fopen(Sidecar(dump, ".uploaded").c_str(), "w");
+            if (marker)
+                std::fclose(marker);
+        }
+
+        void WorkerLoop() {
+            HelperThreads::Enter("upload");
+            std::unique_lock lock(g_Mutex);
+
+            while (!g_Stopping) {
+                if (g_Queue.empty()) {
+                    if (g_InFlight == 0)
+                        break;
+                    g_Wake.wait(lock);
+                    continue;
+                }
+
+                // Pick the dump whose backoff expires first.
+                auto next = std::min_element(g_Queue.begin(), g_Queue.end(), [](const auto &a, const auto &b) {
+                    return a.notBefore < b.notBefore;
+                });
+                const auto startAt = std::max(next->notBefore, g_NextSlot);
+                if (Clock::now() < startAt) {
+                    g_Wake.wait_until(lock, startAt);
+                    continue;
+                }
+
+                PendingDump dump = *next;
+                g_Queue.erase(next);
+
+                const uintmax_t bytes = FileSize(dump.path) + FileSize(Sidecar(dump.path, ".txt")) +
+                                        FileSize(Sidecar(dump.path, ".json"));
+                const auto cost = std::chrono::milliseconds(bytes * 1000 / std::max(1, g_Config.maxBytesPerSec));
+                g_NextSlot = std::max(g_NextSlot, Clock::now()) + cost;
+                ++g_InFlight;
+
+                lock.unlock();
+                std::string error;
+                const bool uploaded = Upload(dump.path, error);
+                if (uploaded)
+                    ApplyRetention(dump.path);
+                lock.lock();
+
+                --g_InFlight;
+                ++dump.attempts;
+
+                // Stop may have given up on this worker and the log may already be closed. Whatever is left is
+                // picked up again on the next start.
+                if (g_Stopping)
+                    break;
+
+                if (uploaded) {
+                    ACC_CORE_INFO("Crash dump uploaded: {}", dump.path);
+                } else if (dump.attempts >= g_Config.maxAttempts) {
+                    ACC_CORE_WARN("Giving up on crash dump {} after {} attempts: {}", dump.path, dump.attempts, error);
+                } else {
+                    const int delay = std::min(g_Config.retryMaxSec, g_Config.retryBaseSec << std::min(dump.attempts - 1, 16));
+                    ACC_CORE_WARN("Crash dump upload failed ({}), retrying {} in {}s", error, dump.path, delay);
+                    dump.notBefore = Clock::now() + std::chrono::seconds(delay);
+                    g_Queue.push_back(std::move(dump));
+                }
+
+                g_Wake.notify_all();
+            }
+
+            --g_Running;
+            g_Exited.notify_all();
+        }
+
+        // Detached workers still run code from this library, so it must stay mapped when Metamod unloads the plugin.
+        void PinLibrary() {
+            Dl_info info{};
+            if (dladdr(reinterpret_cast<void *>(&WorkerLoop), &info) && info.dli_fname)
+                dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD | RTLD_NODELETE);
+        }
+    }
+
+    bool CrashUploader::Start(const CrashUploadConfig &config) {
+        std::lock_guard lock(g_Mutex);
+
+        if (!g_Workers.empty() || config.url.empty())
+            return false;
+
+        if (g_Running) {
+            ACC_CORE_WARN("A crash dump upload from before the reload is still running, not uploading this time.");
+            return false;
+        }
+
+        g_Config = config;
+        g_Config.maxConcurrent = std::clamp(g_Config.maxConcurrent, 1, 4);
+        g_Stopping = false;
+        g_InFlight = 0;
+        g_NextSlot = Clock::now();
+        g_Queue.clear();
+
+        std::error_code ec;
+        for (const auto &entry: fs::directory_iterator(g_Config.dumpDirectory, ec)) {
+            if (!entry.is_regular_file(ec) || entry.path().extension() != ".dmp")
+                continue;
+            // Written on memory pressure while the server kept running, not a crash.
+            if (entry.path().filename().string().starts_with("pressure_"))
+                continue;
+
+            const std::string path = entry.path().string();
+            if (fs::exists(Sidecar(path, ".uploaded"), ec))
+                continue;
+            g_Queue.push_back({path, 0, Clock::now()});
+        }
+
+        if (g_Queue.empty())
+            return true;
+
+        ACC_CORE_INFO("Uploading {} pending crash dump(s) to {}", g_Queue.size(), g_Config.url);
+
+        const size_t workers = std::min<size_t>(g_Config.maxConcurrent, g_Queue.size());
+        for (size_t i = 0; i < workers; ++i) {
+            ++g_Running;
+            g_Workers.emplace_back(WorkerLoop);
+        }
+        return true;
+    }
+
+    void CrashUploader::Stop() {
+        std::vector<std::thread> workers;
+        bool finished;
+        {
+            std::unique_lock lock(g_Mutex);
+            g_Stopping = true;
+            workers.swap(g_Workers);
+            g_Wake.notify_all();
+
+            // An upload in flight gets a moment to finish, anything still queued is picked up again on the next
+            // start. A collector that stopped answering must not hold up the server shutdown.
+            finished = g_Exited.wait_for(lock, kStopTimeout, [] { return g_Running == 0; });
+        }
+
+        if (finished) {
+            for (auto &worker: workers)
+                worker.join();
+            return;
+        }
+
+        PinLibrary();
+        for (auto &worker: workers)
+            worker.detach();
+        ACC_CORE_WARN("Crash dump upload did not finish within {}s, leaving it running in the background.",
+                      kStopTimeout.count());
+    }
+}
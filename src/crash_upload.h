@@ -0,0 +1,36 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <string>
+
+namespace acceleratorcss {
+    enum class UploadRetention {
+        Mark,
+        Delete,
+    };
+
+    struct CrashUploadConfig {
+        std::string url;
+        std::string dumpDirectory;
+        int maxConcurrent = 1;
+        int maxBytesPerSec = 512 * 1024;
+        int maxAttempts = 8;
+        int retryBaseSec = 30;
+        int retryMaxSec = 3600;
+        UploadRetention retention = UploadRetention::Mark;
+    };
+
+    // Ships minidumps left over from previous runs, together with their .txt/.json sidecars, to an HTTP collector.
+    // Uploads run on a few helper threads, are paced to the configured bandwidth and retried with exponential
+    // backoff. Uploaded dumps get a .uploaded marker or are deleted, depending on the retention policy. Stop waits a few
+    // seconds for uploads in flight and then leaves them running detached.
+    class CrashUploader {
+    public:
+        static bool Start(const CrashUploadConfig &config);
+
+        static void Stop();
+    };
+}
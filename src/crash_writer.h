@@ -0,0 +1,118 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    // Buffered file writer for the crash handler. Writes go through a fixed member buffer straight to write(2),
+    // so nothing here touches the heap, which may be corrupted by the time we run.
+    class CrashWriter {
+    public:
+        explicit CrashWriter(const char *path) {
+            m_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+
+        ~CrashWriter() { Close(); }
+
+        CrashWriter(const CrashWriter &) = delete;
+
+        CrashWriter &operator=(const CrashWriter &) = delete;
+
+        bool IsOpen() const { return m_fd >= 0; }
+
+        size_t BytesWritten() const { return m_total + m_used; }
+
+        void Close() {
+            if (m_fd < 0)
+                return;
+            Flush();
+            close(m_fd);
+            m_fd = -1;
+        }
+
+        void Write(const char *data, size_t len) {
+            if (m_fd < 0 || !data)
+                return;
+
+            while (len > 0) {
+                if (m_used == sizeof(m_buffer))
+                    Flush();
+
+                const size_t chunk = len < sizeof(m_buffer) - m_used ? len : sizeof(m_buffer) - m_used;
+                memcpy(m_buffer + m_used, data, chunk);
+                m_used += chunk;
+                data += chunk;
+                len -= chunk;
+            }
+        }
+
+        void Write(const char *str) {
+            if (str)
+                Write(str, strlen(str));
+        }
+
+        void Printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+            char line[1024];
+            va_list args;
+            va_start(args, fmt);
+            int len = vsnprintf(line, sizeof(line), fmt, args);
+            va_end(args);
+
+            if (len > 0)
+                Write(line, static_cast<size_t>(len) < sizeof(line) ? static_cast<size_t>(len) : sizeof(line) - 1);
+        }
+
+        // Writes str as a quoted JSON string literal.
+        void JsonString(const char *str, size_t len) {
+            static const char kHex[] = "0123456789abcdef";
+
+            Write("\"", 1);
+            for (size_t i = 0; str && i < len; ++i) {
+                const auto c = static_cast<unsigned char>(str[i]);
+                switch (c) {
+                    case '"': Write("\\\"", 2); break;
+                    case '\\': Write("\\\\", 2); break;
+                    case '\n': Write("\\n", 2); break;
+                    case '\r': Write("\\r", 2); break;
+                    case '\t': Write("\\t", 2); break;
+                    default:
+                        if (c < 0x20) {
+                            const char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                            Write(escaped, sizeof(escaped));
+                        } else {
+                            Write(reinterpret_cast<const char *>(&c), 1);
+                        }
+                }
+            }
+            Write("\"", 1);
+        }
+
+        void JsonString(const char *str) { JsonString(str, str ? strlen(str) : 0); }
+
+    private:
+        void Flush() {
+            size_t offset = 0;
+            while (offset < m_used) {
+                const ssize_t written = write(m_fd, m_buffer + offset, m_used - offset);
+                if (written <= 0)
+                    break;
+                offset += static_cast<size_t>(written);
+            }
+            m_total += m_used;
+            m_used = 0;
+        }
+
+        int m_fd = -1;
+        char m_buffer[8192];
+        size_t m_used = 0;
+        size_t m_total = 0;
+    };
+}
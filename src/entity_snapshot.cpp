@@ -0,0 +1,93 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "entity_snapshot.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iterator>
+
+namespace acceleratorcss {
+    namespace {
+        struct ClassSlot {
+            const char *classname;
+            uint32_t count;
+        };
+
+        // Only touched by the game thread while a snapshot is being built.
+        ClassSlot g_Classes[EntitySnapshot::kMaxClasses];
+        ClassSlot *g_Used[EntitySnapshot::kMaxClasses];
+        size_t g_UsedCount = 0;
+        uint32_t g_Total = 0;
+        int g_HighestIndex = -1;
+
+        EntitySummary g_Summaries[2];
+        std::atomic<int> g_Published{-1};
+
+        static_assert(std::size(EntitySummary{}.top) == EntitySnapshot::kTopClasses);
+
+        size_t PointerHash(const char *name) {
+            return static_cast<size_t>((reinterpret_cast<uintptr_t>(name) >> 3) * 0x9E3779B97F4A7C15ull >> 53);
+        }
+    }
+
+    void EntitySnapshot::Begin() {
+        for (size_t i = 0; i < g_UsedCount; ++i)
+            *g_Used[i] = {};
+        g_UsedCount = 0;
+        g_Total = 0;
+        g_HighestIndex = -1;
+    }
+
+    void EntitySnapshot::Add(const char *classname, int index) {
+        g_Total++;
+        g_HighestIndex = std::max(g_HighestIndex, index);
+
+        if (!classname)
+            classname = "[unnamed]";
+
+        size_t slot = PointerHash(classname) % kMaxClasses;
+        for (size_t probe = 0; probe < kMaxClasses; ++probe, slot = (slot + 1) % kMaxClasses) {
+            ClassSlot &entry = g_Classes[slot];
+            if (entry.classname == classname) {
+                entry.count++;
+                return;
+            }
+            if (!entry.classname) {
+                entry = {classname, 1};
+                g_Used[g_UsedCount++] = &entry;
+                return;
+            }
+        }
+    }
+
+    void EntitySnapshot::Commit(uint64_t tick) {
+        const size_t top = std::min(g_UsedCount, kTopClasses);
+        std::partial_sort(g_Used, g_Used + top, g_Used + g_UsedCount, [](const ClassSlot *a, const ClassSlot *b) {
+            return a->count > b->count;
+        });
+
+        const int published = g_Published.load(std::memory_order_relaxed);
+        EntitySummary &summary = g_Summaries[published == 0 ? 1 : 0];
+        summary.tick = tick;
+        summary.timestampNs = MonotonicNs();
+        summary.total = g_Total;
+        summary.highestIndex = g_HighestIndex;
+        summary.classCount = static_cast<uint32_t>(g_UsedCount);
+        summary.topCount = static_cast<uint32_t>(top);
+        for (size_t i = 0; i < top; ++i) {
+            std::snprintf(summary.top[i].classname, sizeof(summary.top[i].classname), "%s", g_Used[i]->classname);
+            summary.top[i].count = g_Used[i]->count;
+        }
+
+        g_Published.store(published == 0 ? 1 : 0, std::memory_order_release);
+    }
+
+    const EntitySummary *EntitySnapshot::Latest() {
+        const int published = g_Published.load(std::memory_order_acquire);
+        return published < 0 ? nullptr : &g_Summaries[published];
+    }
+}
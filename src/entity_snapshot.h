@@ -0,0 +1,43 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct EntityClassCount {
+        char classname[64];
+        uint32_t count;
+    };
+
+    struct EntitySummary {
+        uint64_t tick;
+        uint64_t timestampNs;
+        uint32_t total;
+        int highestIndex;
+        uint32_t classCount;
+        uint32_t topCount;
+        EntityClassCount top[20];
+    };
+
+    // Periodic summary of the entity list, built on the game thread into preallocated buffers and published by
+    // swapping an index, so the crash handler can read the latest one without touching the entity system.
+    class EntitySnapshot {
+    public:
+        static constexpr size_t kTopClasses = 20;
+        static constexpr size_t kMaxClasses = 2048;
+
+        static void Begin();
+
+        // Classnames are engine symbols, the same pointer is used for every entity of a class.
+        static void Add(const char *classname, int index);
+
+        static void Commit(uint64_t tick);
+
+        // Latest committed summary, or nullptr if none was taken yet.
+        static const EntitySummary *Latest();
+    };
+}
@@ -0,0 +1,103 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "exception_trace.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace acceleratorcss {
+    namespace {
+        struct Slot {
+            // 2 * index + 1 while the record is being written, 2 * index + 2 once it is published.
+            std::atomic<uint64_t> seq{0};
+            ExceptionRecord record;
+        };
+
+        Slot g_Slots[ExceptionTrace::kCapacity];
+        std::atomic<uint64_t> g_Head{0};
+
+        std::atomic<uint32_t> g_MaxPerSecond{100};
+        std::atomic<uint32_t> g_CurrentSecond{0};
+
+        uint32_t g_History[ExceptionTrace::kHistorySeconds];
+        std::atomic<uint64_t> g_HistoryCount{0};
+        std::chrono::steady_clock::time_point g_LastAdvance;
+        bool g_AdvanceStarted = false;
+    }
+
+    void ExceptionTrace::SetMaxPerSecond(uint32_t maxPerSecond) {
+        g_MaxPerSecond.store(maxPerSecond, std::memory_order_relaxed);
+    }
+
+    void ExceptionTrace::Record(uint32_t typeId, uint32_t methodId, int32_t hresult, int managedTid) {
+        const uint32_t thisSecond = g_CurrentSecond.fetch_add(1, std::memory_order_relaxed);
+        if (thisSecond >= g_MaxPerSecond.load(std::memory_order_relaxed))
+            return;
+
+        const uint64_t index = g_Head.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = g_Slots[index % kCapacity];
+
+        slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.record = {MonotonicNs(), g_ServerTick.load(std::memory_order_relaxed), typeId, methodId, hresult,
+                       CurrentThreadId(), managedTid};
+
+        slot.seq.store(2 * index + 2, std::memory_order_release);
+    }
+
+    void ExceptionTrace::Advance() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!g_AdvanceStarted) {
+            g_AdvanceStarted = true;
+            g_LastAdvance = now;
+            return;
+        }
+        if (now - g_LastAdvance < std::chrono::seconds(1))
+            return;
+        g_LastAdvance = now;
+
+        const uint64_t count = g_HistoryCount.load(std::memory_order_relaxed);
+        g_History[count % kHistorySeconds] = g_CurrentSecond.exchange(0, std::memory_order_relaxed);
+        g_HistoryCount.store(count + 1, std::memory_order_release);
+    }
+
+    size_t ExceptionTrace::Recent(ExceptionRecord *out, size_t max) {
+        const uint64_t head = g_Head.load(std::memory_order_acquire);
+        const uint64_t available = std::min<uint64_t>(head, kCapacity);
+        size_t written = 0;
+
+        for (uint64_t newest = 0; newest < available && written < max; ++newest) {
+            const uint64_t index = head - 1 - newest;
+            const Slot &slot = g_Slots[index % kCapacity];
+
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before != 2 * index + 2)
+                continue;
+
+            out[written] = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before)
+                ++written;
+        }
+
+        return written;
+    }
+
+    size_t ExceptionTrace::PerSecond(uint32_t *out, size_t max) {
+        const uint64_t count = g_HistoryCount.load(std::memory_order_acquire);
+        const size_t seconds = std::min<uint64_t>({count, kHistorySeconds, max});
+
+        for (size_t back = 0; back < seconds; ++back)
+            out[back] = g_History[(count - 1 - back) % kHistorySeconds];
+        return seconds;
+    }
+
+    uint32_t ExceptionTrace::CurrentSecond() {
+        return g_CurrentSecond.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct ExceptionRecord {
+        uint64_t timestampNs;
+        uint64_t tick;
+        uint32_t typeId;
+        uint32_t methodId;
+        int32_t hresult;
+        int tid;
+        int managedTid;
+    };
+
+    // First-chance exceptions reported by the managed side. Every exception is counted, but only the first
+    // maxPerSecond of each second are stored in the ring so an exception storm cannot flush out the history.
+    class ExceptionTrace {
+    public:
+        static constexpr size_t kCapacity = 256;
+        static constexpr size_t kHistorySeconds = 64;
+
+        static void SetMaxPerSecond(uint32_t maxPerSecond);
+
+        static void Record(uint32_t typeId, uint32_t methodId, int32_t hresult, int managedTid);
+
+        static void Advance();
+
+        // Copies up to max records into out, newest first. Lock-free, safe to call from the crash handler.
+        static size_t Recent(ExceptionRecord *out, size_t max);
+
+        // Exception counts of the last completed seconds, newest first. Returns the number of seconds written.
+        static size_t PerSecond(uint32_t *out, size_t max);
+
+        // Exceptions thrown in the second that is still in progress.
+        static uint32_t CurrentSecond();
+    };
+}
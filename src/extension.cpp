@@ -4,25 +4,57 @@
 //
 #include "extension.h"
 #include "CMiniDumpComment.hpp"
+#include "callback_ingest.h"
+#include "callback_stats.h"
+#include "callback_trace.h"
+#include "capture.h"
+#include "crash_report.h"
+#include "crash_upload.h"
+#include "entity_snapshot.h"
+#include "exception_trace.h"
+#include "game_event_trace.h"
+#include "gamedata.h"
+#include "helper_threads.h"
 #include "log.h"
+#include "memory_tracker.h"
+#include "metrics_server.h"
+#include "names.h"
+#include "net_trace.h"
+#include "pressure_monitor.h"
+#include "sampler.h"
+#include "sched_stats.h"
+#include "tick_stats.h"
+#include "timing.h"
+#include "trace_governor.h"
 
 #include <nlohmann/json.hpp>
 #include <entitysystem.h>
 #include <entity2/entitysystem.h>
+#include <engine/igameresourceservice.h>
+#include <igameeventsystem.h>
+#include <networksystem/inetworkmessages.h>
+#include <networksystem/netmessage.h>
+#include <tier1/convar.h>
 
+#include <bit>
 #include <csignal>
 #include <ctime>
 #include <deque>
 #include <dirent.h>
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <limits.h>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <signal.h>
 #include <sstream>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/file.h>
 #include <sys/stat.h>
 #include <thread>
 #include <unistd.h>
@@ -31,8 +63,6 @@
 #include <corecrt_io.h>
 #else
 #include "client/linux/handler/exception_handler.h"
-#include "common/linux/linux_libc_support.h"
-#include "third_party/lss/linux_syscall_support.h"
 #include "common/linux/http_upload.h"
 #endif
 
@@ -48,21 +78,55 @@
 #include "processor/stackwalk_common.h"
 #include "processor/pathname_stripper.h"
 
-size_t g_MaxCallbackTrace = 10;
-
-struct CallbackTraceEntry {
-    std::string name;
-    std::string profile;
-    std::string callerStack;
-};
-
-std::vector<CallbackTraceEntry> g_CallbackTraceBuffer;
-size_t g_CallbackTraceIndex = 0;
-std::mutex g_CallbackTraceMutex;
+using acceleratorcss::CallbackIngest;
+using acceleratorcss::CallbackStats;
+using acceleratorcss::CallbackTrace;
+using acceleratorcss::CallbackTraceRecord;
+using acceleratorcss::CrashContext;
+using acceleratorcss::CrashReport;
+using acceleratorcss::CrashReportFiles;
+using acceleratorcss::CrashTiming;
+using acceleratorcss::CrashUploadConfig;
+using acceleratorcss::CrashUploader;
+using acceleratorcss::EntitySnapshot;
+using acceleratorcss::EntitySummary;
+using acceleratorcss::ExceptionTrace;
+using acceleratorcss::GameData;
+using acceleratorcss::GameEventTrace;
+using acceleratorcss::GcSnapshot;
+using acceleratorcss::HelperThreadConfig;
+using acceleratorcss::HelperThreadPolicy;
+using acceleratorcss::HelperThreads;
+using acceleratorcss::MemorySample;
+using acceleratorcss::MemoryTracker;
+using acceleratorcss::MemoryTrackerConfig;
+using acceleratorcss::MetricsServer;
+using acceleratorcss::MetricsServerConfig;
+using acceleratorcss::NameTable;
+using acceleratorcss::NetMessageTrace;
+using acceleratorcss::PressureMonitor;
+using acceleratorcss::PressureMonitorConfig;
+using acceleratorcss::SamplerConfig;
+using acceleratorcss::SchedStats;
+using acceleratorcss::StackSampler;
+using acceleratorcss::TickStats;
+using acceleratorcss::TraceCapture;
+using acceleratorcss::TraceControl;
+using acceleratorcss::TraceGovernor;
+using acceleratorcss::TraceGovernorConfig;
+using acceleratorcss::TraceLevel;
+using acceleratorcss::UploadRetention;
+
+// Set when the crash handler starts, the minidump is written between dumpFilter and dumpCallback.
+static uint64_t s_CrashStartNs = 0;
+// Filled by the crash handler, kept out of its stack.
+static CrashReportFiles s_CrashFiles;
 
 namespace fs = std::filesystem;
 
 ISmmAPI *g_ISmm = nullptr;
+IGameEventSystem *g_pGameEventSystem = nullptr;
+IGameEventManager2 *g_pGameEventManager = nullptr;
 
 static std::string lastMap;
 char crashMap[256];
@@ -99,45 +163,102 @@ struct PluginConfig {
 
 PluginConfig config{};
 
-DLL_EXPORT void RegisterCallbackTraceBinary(const void* data, size_t len) {
-    if (!data || len < 6) return;
+bool g_DumpIncludeDiagnostics = true;
+static const void *s_DumpTraceRegion = nullptr;
+
+bool g_PressureMinidump = false;
+// Held while this process owns the persistent trace files, the kernel drops the lock when it dies, even on SIGKILL.
+static int s_TraceLockFd = -1;
+bool g_NetTraceEnabled = false;
+bool g_EventTraceEnabled = false;
+
+int g_EntitySystemOffset = -1;
+int g_EntitySnapshotIntervalSec = 5;
+std::chrono::steady_clock::time_point g_LastEntitySnapshot;
 
-    const char* raw = reinterpret_cast<const char*>(data);
-    uint16_t nameLen = *reinterpret_cast<const uint16_t*>(raw);
-    uint16_t profileLen = *reinterpret_cast<const uint16_t*>(raw + 2);
-    uint16_t stackLen = *reinterpret_cast<const uint16_t*>(raw + 4);
+bool g_SamplerEnabled = false;
+bool g_SamplerStartAttempted = false;
+SamplerConfig g_SamplerConfig;
 
-    if (len < 6 + nameLen + profileLen + stackLen) return;
+template <typename T>
+static T configValue(const char *key, T fallback) {
+    const auto &cfg = acceleratorcss::g_Config;
+    if (!cfg.is_object() || !cfg.contains(key))
+        return fallback;
 
-    std::string name(raw + 6, nameLen);
-    std::string profile(raw + 6 + nameLen, profileLen);
-    std::string stack(raw + 6 + nameLen + profileLen, stackLen);
+    try {
+        return cfg[key].get<T>();
+    } catch (...) {
+        ACC_CORE_WARN("Config value {} has the wrong type, using the default.", key);
+        return fallback;
+    }
+}
 
-    if (config.LogCallbacksToConsole) {
-        ACC_CORE_INFO("[Callback] Name: {}", name);
+DLL_EXPORT uint32_t RegisterCallbackMethod(const char* name, size_t len, bool filtered) {
+    uint32_t methodId = NameTable::Intern(name, len);
+    if (methodId == NameTable::kInvalidId) {
+        ACC_CORE_WARN("Method table is full, callback will not be traced: {}", std::string_view(name, len));
+        return methodId;
     }
 
-    std::lock_guard lock(g_CallbackTraceMutex);
+    CallbackStats::SetFiltered(methodId, filtered);
+    return methodId;
+}
 
-    if (g_CallbackTraceBuffer.empty())
-        return;
+DLL_EXPORT void RegisterCallbackTraceBinary(const void* data, size_t len) {
+    CallbackIngest::Enter(data, len);
+}
 
-    size_t bufferSize = g_CallbackTraceBuffer.size();
-    g_CallbackTraceBuffer[g_CallbackTraceIndex % bufferSize] = {
-        std::move(name), std::move(profile), std::move(stack)
-    };
-    g_CallbackTraceIndex++;
+DLL_EXPORT uint32_t RegisterName(const char* name, size_t len) {
+    return NameTable::Intern(name, len);
 }
 
-void SetMaxCallbackTrace(size_t newSize) {
-    std::lock_guard lock(g_CallbackTraceMutex);
+DLL_EXPORT void RegisterFirstChanceException(uint32_t typeId, uint32_t methodId, int32_t hresult, int32_t managedTid) {
+    ExceptionTrace::Record(typeId, methodId, hresult, managedTid);
+}
+
+DLL_EXPORT void PublishGcSnapshot(const GcSnapshot* snapshot) {
+    if (snapshot)
+        TickStats::PublishGc(*snapshot);
+}
+
+DLL_EXPORT void PublishPluginAllocations(const uint32_t* nameIds, const uint64_t* bytes, int32_t count) {
+    if (nameIds && bytes && count > 0)
+        TickStats::PublishPluginAllocations(nameIds, bytes, static_cast<size_t>(count));
+}
+
+DLL_EXPORT void RegisterCallbackExit() {
+    CallbackIngest::Exit();
+}
+
+DLL_EXPORT void RegisterCallbackCount(uint32_t methodId) {
+    CallbackIngest::Count(methodId);
+}
 
-    if (newSize == 0)
+// Read by the managed Harmony prefix on every call to pick the trace level, which also adds its own time to it.
+DLL_EXPORT TraceControl* GetTraceControl() {
+    return TraceGovernor::Control();
+}
+
+// Keeps the callback trace ring registered as extra minidump memory, it moves whenever the ring is resized.
+static void registerTraceMemory() {
+    if (!exceptionHandler || !g_DumpIncludeDiagnostics)
+        return;
+
+    const void *data = nullptr;
+    size_t bytes = 0;
+    if (!CallbackTrace::Storage(data, bytes) || data == s_DumpTraceRegion)
         return;
 
-    g_CallbackTraceBuffer.clear();
-    g_CallbackTraceBuffer.resize(newSize);
-    g_CallbackTraceIndex = 0;
+    if (s_DumpTraceRegion)
+        exceptionHandler->UnregisterAppMemory(const_cast<void *>(s_DumpTraceRegion));
+    exceptionHandler->RegisterAppMemory(const_cast<void *>(data), bytes);
+    s_DumpTraceRegion = data;
+}
+
+void SetMaxCallbackTrace(size_t newSize) {
+    CallbackTrace::Resize(newSize);
+    registerTraceMemory();
 }
 
 DLL_EXPORT PluginConfig CssPluginRegistered()
@@ -155,8 +276,10 @@ DLL_EXPORT PluginConfig CssPluginRegistered()
             if (j.contains("LightweightMode") && j["LightweightMode"].is_boolean())
                 config.LightweightMode = j["LightweightMode"].get<bool>();
 
-            if (j.contains("LogCallbacksToConsole") && j["LogCallbacksToConsole"].is_boolean())
+            if (j.contains("LogCallbacksToConsole") && j["LogCallbacksToConsole"].is_boolean()) {
                 config.LogCallbacksToConsole = j["LogCallbacksToConsole"].get<bool>();
+                CallbackIngest::SetLogToConsole(config.LogCallbacksToConsole);
+            }
 
             if (j.contains("CallbackLogSize") && j["CallbackLogSize"].is_number_integer()) {
                 config.CallbackLogSize = j["CallbackLogSize"].get<int>();
@@ -186,59 +309,171 @@ DLL_EXPORT PluginConfig CssPluginRegistered()
     return config;
 }
 
+// Runs before the minidump is written, so the console capture lands in the dump's registered memory as well.
+static bool dumpFilter(void *context) {
+    s_CrashStartNs = acceleratorcss::MonotonicNs();
+    LoggingSystem_GetLogCapture(&g_MiniDumpComment, false);
+    return true;
+}
+
+// Everything up to the log calls at the end stays off the heap and takes no locks: the crash may have happened
+// inside malloc or while another thread held the logger's mutex, and the reports should exist either way.
 static bool dumpCallback(const google_breakpad::MinidumpDescriptor &descriptor, void *context, bool succeeded) {
-    ACC_CORE_CRITICAL("- [ Crash detected! Writing custom crash log... ] -");
+    CallbackTrace::MarkCrashReported();
+
+    const CrashContext crashContext{ACCELERATORCSS_VERSION, crashMap, crashGamePath, crashCommandLine,
+                                    g_MiniDumpComment.GetStartPointer()};
+    CrashReport::Write(descriptor.path(), crashContext, s_CrashStartNs, s_CrashFiles);
+    const CrashTiming &timing = s_CrashFiles.timing;
+
+    ACC_CORE_CRITICAL("- [ Crash detected! Minidump written to: {} ] -", descriptor.path());
+    if (s_CrashFiles.textWritten)
+        ACC_CORE_INFO("Custom crash log written to: {}", s_CrashFiles.textPath);
+    else
+        ACC_CORE_ERROR("- [ Failed to open crash log file: {} ] -", s_CrashFiles.textPath);
+    if (s_CrashFiles.jsonWritten)
+        ACC_CORE_INFO("Structured crash report written to: {}", s_CrashFiles.jsonPath);
+    else
+        ACC_CORE_ERROR("- [ Failed to open crash report file: {} ] -", s_CrashFiles.jsonPath);
+    ACC_CORE_INFO("Crash handler took {:.3f} ms: minidump {:.3f} ms ({} bytes), text report {:.3f} ms ({} bytes), "
+                  "json report {:.3f} ms.",
+                  static_cast<double>(timing.minidumpNs + timing.textNs + s_CrashFiles.jsonNs) / 1e6,
+                  static_cast<double>(timing.minidumpNs) / 1e6, timing.minidumpBytes,
+                  static_cast<double>(timing.textNs) / 1e6, timing.textBytes,
+                  static_cast<double>(s_CrashFiles.jsonNs) / 1e6);
+
+    return s_CrashFiles.textWritten;
+}
 
-    my_strlcpy(dumpStoragePath, descriptor.path(), sizeof(dumpStoragePath));
-    my_strlcat(dumpStoragePath, ".txt", sizeof(dumpStoragePath));
+// Breakpad names the dump <uuid>.dmp like a crash dump, it is renamed so the uploader and the crash counters can
+// tell the two apart.
+static bool pressureDumpWritten(const google_breakpad::MinidumpDescriptor &descriptor, void *context, bool succeeded) {
+    if (!succeeded) {
+        ACC_CORE_ERROR("Failed to write the memory pressure minidump.");
+        return false;
+    }
 
-    std::ofstream dumpFile(dumpStoragePath, std::ios::out | std::ios::trunc);
-    if (!dumpFile.is_open()) {
-        ACC_CORE_ERROR("- [ Failed to open crash log file: {} ] -", dumpStoragePath);
+    const auto *path = static_cast<const std::string *>(context);
+    if (std::rename(descriptor.path(), path->c_str()) != 0) {
+        ACC_CORE_ERROR("Failed to rename the memory pressure minidump {}, removing it.", descriptor.path());
+        unlink(descriptor.path());
         return false;
     }
 
-    dumpFile << "-------- CONFIG BEGIN --------\n";
-    dumpFile << "Map=" << crashMap << "\n";
-    dumpFile << "GamePath=" << crashGamePath << "\n";
-    dumpFile << "CommandLine=" << crashCommandLine << "\n";
-    dumpFile << "-------- CONFIG END --------\n\n";
+    ACC_CORE_WARN("Memory pressure minidump written to: {}", *path);
+    return true;
+}
 
-    LoggingSystem_GetLogCapture(&g_MiniDumpComment, false);
-    const char *pszConsoleHistory = g_MiniDumpComment.GetStartPointer();
+// Runs on the pressure monitor thread while the server keeps going, so it only uses readers that are safe next to
+// the game thread and its own buffers instead of the crash handler's scratch.
+static void writePressureSnapshot(const char *reason) {
+    constexpr size_t kSnapshotCallbacks = 64;
 
-    if (pszConsoleHistory[0]) {
-        dumpFile << "-------- CONSOLE HISTORY BEGIN --------\n";
-        dumpFile << pszConsoleHistory;
-        dumpFile << "-------- CONSOLE HISTORY END --------\n\n";
+    const std::string basePath = Paths::Logs() + "/pressure_" + std::to_string(static_cast<long>(std::time(nullptr)));
+    const std::string path = basePath + ".txt";
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        ACC_CORE_ERROR("Failed to open memory pressure snapshot: {}", path);
+        return;
     }
 
-    dumpFile << "-------- CALLBACK TRACE BEGIN --------\n";
+    const uint64_t nowNs = acceleratorcss::MonotonicNs();
+    file << "-------- MEMORY PRESSURE --------\n"
+         << "Tick: " << acceleratorcss::g_ServerTick.load() << ", map: " << crashMap << "\n" << reason << "\n";
+
+    file << "-------- MEMORY HISTORY BEGIN -> NEWEST IS FIRST --------\n";
     {
-        std::lock_guard lock(g_CallbackTraceMutex);
+        MemorySample samples[CrashReport::kMemorySamples];
+        const size_t count = MemoryTracker::Recent(samples, CrashReport::kMemorySamples);
+        for (size_t i = 0; i < count; ++i) {
+            file << "[-" << std::fixed << std::setprecision(0)
+                 << static_cast<double>(nowNs - samples[i].timestampNs) / 1e9 << " s] tick " << samples[i].tick
+                 << ": RSS " << samples[i].rssBytes / (1024 * 1024) << " MB, PSS " << samples[i].pssBytes / (1024 * 1024)
+                 << " MB, anonymous " << samples[i].anonymousBytes / (1024 * 1024) << " MB, managed heap "
+                 << samples[i].managedHeapBytes / (1024 * 1024) << " MB\n";
+        }
+    }
+    file << "-------- MEMORY HISTORY END --------\n\n";
+
+    file << "-------- ENTITIES BEGIN --------\n";
+    if (const EntitySummary *entities = EntitySnapshot::Latest()) {
+        file << "Snapshot from tick " << entities->tick << "\nEntities: " << entities->total << ", highest index: "
+             << entities->highestIndex << ", classes: " << entities->classCount << "\n";
+        for (uint32_t i = 0; i < entities->topCount; ++i)
+            file << std::setw(10) << entities->top[i].count << "  " << entities->top[i].classname << "\n";
+    } else {
+        file << "No entity snapshot was taken.\n";
+    }
+    file << "-------- ENTITIES END --------\n\n";
 
-        const size_t bufferSize = g_CallbackTraceBuffer.size();
-        const size_t validCount = std::min(bufferSize, g_CallbackTraceIndex);
+    file << "-------- CALLBACK TRACE BEGIN -> NEWEST CALLBACK IS FIRST --------\n";
+    {
+        auto record = std::make_unique<CallbackTraceRecord>();
+        auto text = std::make_unique<char[]>(4096);
+        const size_t count = std::min(CallbackTrace::Count(), kSnapshotCallbacks);
+        for (size_t i = 0; i < count; ++i) {
+            if (!CallbackTrace::Read(i, *record))
+                continue;
+
+            file << "[-" << std::fixed << std::setprecision(3)
+                 << static_cast<double>(static_cast<int64_t>(nowNs - record->timestampNs)) / 1e6 << " ms] tick "
+                 << record->tick << ", thread " << record->tid << "\nName: " << NameTable::Get(record->methodId) << "\n";
+            if (record->argsLen)
+                file << "Args: " << std::string_view(text.get(), CallbackTrace::FormatArgs(*record, text.get(), 4096))
+                     << "\n";
+            for (size_t frame = 0; frame < record->frameCount; ++frame)
+                file << "   at "
+                     << std::string_view(text.get(), CallbackTrace::FormatFrame(record->frames[frame], text.get(), 4096))
+                     << "\n";
+        }
+    }
+    file << "-------- CALLBACK TRACE END --------\n";
+    file.close();
 
-        for (size_t i = 0; i < validCount; ++i) {
-            size_t idx = (g_CallbackTraceIndex - 1 - i) % bufferSize;
-            const auto& entry = g_CallbackTraceBuffer[idx];
+    ACC_CORE_WARN("Memory pressure snapshot written to: {}", path);
 
-            dumpFile << "Name: " << entry.name << "\n";
-            dumpFile << "Profile: " << entry.profile << "\n";
-            dumpFile << "Stack:\n" << entry.callerStack << "\n";
-            dumpFile << "-----------------------------\n";
-        }
+    // Written by a cloned child while the server keeps running, without going through the crash callback.
+    if (g_PressureMinidump) {
+        std::string dumpPath = basePath + ".dmp";
+        google_breakpad::ExceptionHandler::WriteMinidump(Paths::Logs(), pressureDumpWritten, &dumpPath);
     }
-    dumpFile << "-------- CALLBACK TRACE END --------\n";
+}
+
+// Several servers often share one install and its logs folder, so the trace files are keyed by the game port. The
+// lock catches instances that still collide, e.g. two servers left on the default port.
+static bool lockPersistentTrace(const std::string &lockPath) {
+    const int fd = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
 
-    dumpFile.close();
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return false;
+    }
 
-    ACC_CORE_INFO("Custom crash log written to: {}", dumpStoragePath);
+    s_TraceLockFd = fd;
     return true;
 }
 
-CGameEntitySystem *GameEntitySystem() { return nullptr; }
+CGameEntitySystem *GameEntitySystem() {
+    if (g_EntitySystemOffset < 0 || !g_pGameResourceServiceServer)
+        return nullptr;
+    return *reinterpret_cast<CGameEntitySystem **>(reinterpret_cast<uintptr_t>(g_pGameResourceServiceServer) +
+                                                   g_EntitySystemOffset);
+}
+
+// Walks the entity list on the game thread, the crash handler only ever reads the finished summary.
+static void snapshotEntities(uint64_t tick) {
+    CGameEntitySystem *entitySystem = GameEntitySystem();
+    if (!entitySystem)
+        return;
+
+    EntitySnapshot::Begin();
+    for (CEntityIdentity *identity = entitySystem->m_EntityList.m_pFirstActiveEntity; identity;
+         identity = identity->m_pNext)
+        EntitySnapshot::Add(identity->m_designerName.String(), identity->m_EHandle.GetEntryIndex());
+    EntitySnapshot::Commit(tick);
+}
 
 class GameSessionConfiguration_t {
 };
@@ -248,6 +483,45 @@ PLUGIN_EXPOSE(AcceleratorCSS_MM, acceleratorcss::gPlugin);
 SH_DECL_HOOK3_void(IServerGameDLL, GameFrame, SH_NOATTRIB, 0, bool, bool, bool);
 SH_DECL_HOOK3_void(INetworkServerService, StartupServer, SH_NOATTRIB, 0, const GameSessionConfiguration_t&,
                    ISource2WorldSession*, const char*);
+SH_DECL_HOOK8_void(IGameEventSystem, PostEventAbstract, SH_NOATTRIB, 0, CSplitScreenSlot, bool, int, const uint64 *,
+                   INetworkMessageInternal *, const CNetMessage *, unsigned long, NetChannelBufType_t);
+
+SH_DECL_HOOK2(IGameEventManager2, FireEvent, SH_NOATTRIB, 0, bool, IGameEvent *, bool);
+
+static bool Hook_FireEvent(IGameEvent *event, bool bDontBroadcast) {
+    if (event)
+        GameEventTrace::Record(event->GetName());
+    RETURN_META_VALUE(MRES_IGNORED, true);
+}
+
+// IGameEventManager2 is not exported, the server returns a pointer 8 bytes past it from a virtual at this offset.
+static IGameEventManager2 *findGameEventManager() {
+    const int offset = GameData::Offset("GameEventManager");
+    if (offset < 0)
+        return nullptr;
+
+    auto **vtable = *reinterpret_cast<void ***>(g_pSource2Server);
+    auto getter = reinterpret_cast<uintptr_t (*)(ISource2Server *)>(vtable[offset]);
+    const uintptr_t address = getter(g_pSource2Server);
+    return address ? reinterpret_cast<IGameEventManager2 *>(address - 8) : nullptr;
+}
+
+static void Hook_PostEvent(CSplitScreenSlot nSlot, bool bLocalOnly, int nClientCount, const uint64 *clients,
+                           INetworkMessageInternal *pEvent, const CNetMessage *pData, unsigned long nSize,
+                           NetChannelBufType_t bufType) {
+    if (!pEvent)
+        RETURN_META(MRES_IGNORED);
+
+    const NetMessageInfo_t *info = pEvent->GetNetMessageInfo();
+    const uint32_t recipients = clients && nClientCount > 0 ? std::popcount(*clients) : 0;
+
+    // ByteSizeLong only computes the wire size from the message fields, nothing is serialized or parsed.
+    const auto *message = pData ? const_cast<CNetMessage *>(pData)->ToPB<google::protobuf::Message>() : nullptr;
+    const size_t bytes = message ? message->ByteSizeLong() : 0;
+
+    NetMessageTrace::Record(info ? info->m_MessageId : UINT32_MAX, static_cast<uint32_t>(bytes), recipients);
+    RETURN_META(MRES_IGNORED);
+}
 
 namespace acceleratorcss {
     AcceleratorCSS_MM gPlugin;
@@ -259,6 +533,9 @@ namespace acceleratorcss {
         GET_V_IFACE_CURRENT(GetServerFactory, g_pSource2Server, ISource2Server, SOURCE2SERVER_INTERFACE_VERSION);
         GET_V_IFACE_CURRENT(GetEngineFactory, g_pNetworkServerService, INetworkServerService, NETWORKSERVERSERVICE_INTERFACE_VERSION);
         GET_V_IFACE_CURRENT(GetEngineFactory, g_pEngineServer, IVEngineServer, INTERFACEVERSION_VENGINESERVER);
+        GET_V_IFACE_CURRENT(GetEngineFactory, g_pCVar, ICvar, CVAR_INTERFACE_VERSION);
+        GET_V_IFACE_CURRENT(GetEngineFactory, g_pGameResourceServiceServer, IGameResourceService,
+                            GAMERESOURCESERVICESERVER_INTERFACE_VERSION);
 
         g_ISmm = ismm;
 
@@ -301,6 +578,7 @@ namespace acceleratorcss {
         }
 
         g_SMAPI->AddListener(this, this);
+        META_CONVAR_REGISTER(FCVAR_RELEASE | FCVAR_GAMEDLL);
 
         try {
             std::ifstream configFile(AcceleratorCSS::paths::ConfigDirectory());
@@ -316,8 +594,125 @@ namespace acceleratorcss {
             g_pluginRegistered = false;
         }
 
+        // Applied by each helper thread when it starts, so this has to come before any of them is created.
+        HelperThreadConfig helperConfig;
+        helperConfig.cpus = configValue<std::string>("HelperThreadCpus", "");
+        helperConfig.nice = configValue("HelperThreadNice", helperConfig.nice);
+        const std::string helperPolicy = configValue<std::string>("HelperThreadPolicy", "batch");
+        if (helperPolicy == "idle")
+            helperConfig.policy = HelperThreadPolicy::Idle;
+        else if (helperPolicy == "normal")
+            helperConfig.policy = HelperThreadPolicy::Normal;
+        HelperThreads::Configure(helperConfig);
+
+        g_SamplerEnabled = configValue("StackSamplerEnabled", false);
+        g_SamplerConfig.frequencyHz = configValue("StackSamplerHz", 99);
+        g_SamplerConfig.exportIntervalSec = configValue("StackSamplerExportIntervalSec", 60);
+        g_SamplerConfig.outputDirectory = Paths::Logs();
+
+        // LightweightMode is read again when the C# plugin registers, the governor only needs it as its ceiling.
+        TraceGovernorConfig governorConfig;
+        governorConfig.budget = configValue("TraceOverheadBudgetPercent", 5.0) / 100.0;
+        governorConfig.restoreSec = configValue("TraceOverheadRestoreSec", governorConfig.restoreSec);
+        governorConfig.sampleEvery = configValue("TraceSampleEvery", governorConfig.sampleEvery);
+        governorConfig.ceiling = configValue("LightweightMode", true) ? TraceLevel::Lightweight : TraceLevel::Full;
+        TraceGovernor::Configure(governorConfig);
+
+        ExceptionTrace::SetMaxPerSecond(configValue("ExceptionTraceMaxPerSec", 100u));
+        TickStats::SetSlowTickThresholdMs(configValue("SlowTickThresholdMs", 50u));
+
+        GameData::Load(AcceleratorCSS::paths::GamedataDirectory());
+
+        g_EntitySystemOffset = GameData::Offset("GameEntitySystem");
+        g_EntitySnapshotIntervalSec = configValue("EntitySnapshotIntervalSec", 5);
+
+        g_EventTraceEnabled = configValue("GameEventTraceEnabled", false);
+        if (g_EventTraceEnabled) {
+            g_pGameEventManager = findGameEventManager();
+            if (g_pGameEventManager)
+                SH_ADD_HOOK(IGameEventManager2, FireEvent, g_pGameEventManager, SH_STATIC(Hook_FireEvent), false);
+            else
+                ACC_CORE_WARN("Game event manager not found, game event tracing is disabled.");
+        }
+
+        g_NetTraceEnabled = configValue("NetMessageTraceEnabled", false);
+        if (g_NetTraceEnabled) {
+            GET_V_IFACE_CURRENT(GetEngineFactory, g_pGameEventSystem, IGameEventSystem, GAMEEVENTSYSTEM_INTERFACE_VERSION);
+            NetMessageTrace::Init();
+            SH_ADD_HOOK(IGameEventSystem, PostEventAbstract, g_pGameEventSystem, SH_STATIC(Hook_PostEvent), false);
+        }
+
+        // The C# plugin registers later, so the ring is only mapped over the previous process' file after recovery.
+        if (configValue("PersistentTraceEnabled", true)) {
+            const int port = CommandLine() ? CommandLine()->ParmValue("-port", 27015) : 27015;
+            const std::string traceKey = Paths::Logs() + "/callback_" + std::to_string(port);
+            const std::string ringPath = traceKey + "_trace.ring";
+            const std::string namesPath = traceKey + "_names.bin";
+            const std::string reportPath =
+                Paths::Logs() + "/unclean_" + std::to_string(static_cast<long>(std::time(nullptr))) + ".txt";
+
+            if (!lockPersistentTrace(traceKey + ".lock")) {
+                ACC_CORE_WARN("Another server with port {} uses {}, the callback trace is kept in memory only and "
+                              "will not survive a SIGKILL.", port, Paths::Logs());
+            } else {
+                if (CallbackTrace::RecoverUnclean(ringPath, namesPath, reportPath))
+                    ACC_CORE_WARN("The previous server process was killed without a crash report, its callback "
+                                  "trace was recovered into: {}", reportPath);
+
+                if (NameTable::Persist(namesPath))
+                    CallbackTrace::SetBackingFile(ringPath);
+                else
+                    ACC_CORE_WARN("Failed to create {}, the callback trace will not survive a SIGKILL.", namesPath);
+            }
+        }
+
+        MemoryTrackerConfig memoryConfig;
+        memoryConfig.intervalSec = configValue("MemoryTrackerIntervalSec", memoryConfig.intervalSec);
+        memoryConfig.windowMinutes = configValue("MemoryGrowthWindowMinutes", memoryConfig.windowMinutes);
+        memoryConfig.warnMbPerMinute = configValue("MemoryGrowthWarnMbPerMinute", memoryConfig.warnMbPerMinute);
+        MemoryTracker::Start(memoryConfig);
+
+        if (configValue("PressureMonitorEnabled", true)) {
+            PressureMonitorConfig pressureConfig;
+            pressureConfig.stallMs = configValue("PressureStallMs", pressureConfig.stallMs);
+            pressureConfig.windowMs = configValue("PressureWindowMs", pressureConfig.windowMs);
+            pressureConfig.cooldownSec = configValue("PressureSnapshotCooldownSec", pressureConfig.cooldownSec);
+            pressureConfig.onPressure = writePressureSnapshot;
+            g_PressureMinidump = configValue("PressureWriteMinidump", false);
+            PressureMonitor::Start(pressureConfig);
+        }
+
+        MetricsServerConfig metricsConfig;
+        metricsConfig.port = configValue("MetricsPort", metricsConfig.port);
+        metricsConfig.logsDirectory = Paths::Logs();
+        if (metricsConfig.port > 0)
+            MetricsServer::Start(metricsConfig);
+
+        CrashUploadConfig uploadConfig;
+        uploadConfig.url = configValue<std::string>("CrashUploadUrl", "");
+        uploadConfig.dumpDirectory = Paths::Logs();
+        uploadConfig.maxConcurrent = configValue("CrashUploadMaxConcurrent", uploadConfig.maxConcurrent);
+        uploadConfig.maxBytesPerSec = configValue("CrashUploadMaxBytesPerSec", uploadConfig.maxBytesPerSec);
+        uploadConfig.maxAttempts = configValue("CrashUploadMaxAttempts", uploadConfig.maxAttempts);
+        if (configValue<std::string>("CrashUploadRetention", "mark") == "delete")
+            uploadConfig.retention = UploadRetention::Delete;
+        CrashUploader::Start(uploadConfig);
+
         google_breakpad::MinidumpDescriptor descriptor(dumpStoragePath);
-        exceptionHandler = new google_breakpad::ExceptionHandler(descriptor, nullptr, dumpCallback, nullptr, true, -1);
+        const int64_t dumpSizeLimitKb = configValue<int64_t>("MinidumpSizeLimitKb", 0);
+        if (dumpSizeLimitKb > 0)
+            descriptor.set_size_limit(static_cast<off_t>(dumpSizeLimitKb) * 1024);
+        exceptionHandler = new google_breakpad::ExceptionHandler(descriptor, dumpFilter, dumpCallback, nullptr, true, -1);
+
+        g_DumpIncludeDiagnostics = configValue("MinidumpIncludeDiagnostics", true);
+        if (g_DumpIncludeDiagnostics) {
+            exceptionHandler->RegisterAppMemory(crashMap, sizeof(crashMap));
+            exceptionHandler->RegisterAppMemory(crashGamePath, sizeof(crashGamePath));
+            exceptionHandler->RegisterAppMemory(crashCommandLine, sizeof(crashCommandLine));
+            exceptionHandler->RegisterAppMemory(const_cast<char *>(g_MiniDumpComment.GetStartPointer()),
+                                                g_MiniDumpComment.GetEndPointer() - g_MiniDumpComment.GetStartPointer());
+            registerTraceMemory();
+        }
 
         struct sigaction oact{};
         sigaction(SIGSEGV, nullptr, &oact);
@@ -328,6 +723,18 @@ namespace acceleratorcss {
     }
 
     bool AcceleratorCSS_MM::Unload(char *error, size_t maxlen) {
+        StackSampler::Stop();
+        TraceCapture::Stop();
+        CrashUploader::Stop();
+        MemoryTracker::Stop();
+        PressureMonitor::Stop();
+        MetricsServer::Stop();
+        CallbackTrace::MarkClean();
+        if (s_TraceLockFd >= 0) {
+            close(s_TraceLockFd);
+            s_TraceLockFd = -1;
+        }
+
         Log::Close();
         g_pluginRegistered = false;
 
@@ -336,8 +743,16 @@ namespace acceleratorcss {
                        true);
         SH_REMOVE_HOOK(INetworkServerService, StartupServer, g_pNetworkServerService,
                        SH_MEMBER(this, &AcceleratorCSS_MM::StartupServer), true);
+        if (g_pGameEventManager)
+            SH_REMOVE_HOOK(IGameEventManager2, FireEvent, g_pGameEventManager, SH_STATIC(Hook_FireEvent), false);
+        if (g_NetTraceEnabled)
+            SH_REMOVE_HOOK(IGameEventSystem, PostEventAbstract, g_pGameEventSystem, SH_STATIC(Hook_PostEvent), false);
+
+        ConVar_Unregister();
 
         delete exceptionHandler;
+        exceptionHandler = nullptr;
+        s_DumpTraceRegion = nullptr;
 
         ACC_CORE_INFO("- [ MM plugin unloaded. ] -");
 
@@ -346,6 +761,7 @@ namespace acceleratorcss {
 
     void AcceleratorCSS_MM::AllPluginsLoaded() {
         std::thread([] {
+            HelperThreads::Enter("status");
             std::this_thread::sleep_for(std::chrono::milliseconds(3000));
             if (g_pluginRegistered)
                 ACC_CORE_INFO("- [ MM plugin is active and linked. ] -");
@@ -358,10 +774,39 @@ namespace acceleratorcss {
         bool weHaveBeenFuckedOver = false;
         struct sigaction oact;
 
+        if (acceleratorcss::g_GameThreadId.load(std::memory_order_relaxed) == 0)
+            acceleratorcss::g_GameThreadId.store(acceleratorcss::CurrentThreadId(), std::memory_order_relaxed);
+        const uint64_t tick = acceleratorcss::g_ServerTick.fetch_add(1, std::memory_order_relaxed) + 1;
+        CallbackTrace::Heartbeat(tick);
+        if (TraceCapture::IsActive())
+            TraceCapture::Record(TraceCapture::Phase::Tick, static_cast<uint32_t>(tick));
+
+        CallbackStats::Advance();
+        ExceptionTrace::Advance();
+        TickStats::OnFrame(tick, SchedStats::OnFrame());
+        SchedStats::Advance();
+        TraceGovernor::OnFrame();
+        NetMessageTrace::Advance();
+        GameEventTrace::Advance();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (g_EntitySnapshotIntervalSec > 0 &&
+            now - g_LastEntitySnapshot >= std::chrono::seconds(g_EntitySnapshotIntervalSec)) {
+            g_LastEntitySnapshot = now;
+            snapshotEntities(tick);
+        }
+
+        // The sampler arms a timer for the calling thread, so it has to be started from the game thread.
+        if (g_SamplerEnabled && !g_SamplerStartAttempted) {
+            g_SamplerStartAttempted = true;
+            StackSampler::Start(g_SamplerConfig);
+        }
+
         auto gs = g_pNetworkServerService->GetIGameServer();
         const char* currentMap = gs ? gs->GetMapName() : nullptr;
         if (currentMap && *currentMap && lastMap != currentMap) {
             std::snprintf(crashMap, sizeof(crashMap), "%s", currentMap);
+            CallbackTrace::SetMap(currentMap);
             lastMap = currentMap;
             ACC_CORE_INFO("- [ Detected map change: {} ] -", currentMap);
         }
@@ -394,8 +839,10 @@ namespace acceleratorcss {
 
     void AcceleratorCSS_MM::StartupServer(const GameSessionConfiguration_t &config, ISource2WorldSession *,
                                           const char *pszMapName) {
-        if (pszMapName && *pszMapName)
+        if (pszMapName && *pszMapName) {
             std::snprintf(crashMap, sizeof(crashMap), "%s", pszMapName);
+            CallbackTrace::SetMap(pszMapName);
+        }
     }
 
     const char *AcceleratorCSS_MM::GetAuthor() { return "Slynx"; }
@@ -0,0 +1,183 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "game_event_trace.h"
+#include "names.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr size_t kPointerSlots = 4096;
+
+        struct EventType {
+            uint32_t nameId;
+            std::atomic<uint64_t> fires{0};
+            uint64_t previousFires;
+        };
+
+        struct PointerSlot {
+            std::atomic<const char *> name{nullptr};
+            uint32_t type;
+        };
+
+        struct Slot {
+            // 2 * index + 1 while the record is being written, 2 * index + 2 once it is published.
+            std::atomic<uint64_t> seq{0};
+            GameEventRecord record;
+        };
+
+        EventType g_Types[GameEventTrace::kMaxEventTypes];
+        std::atomic<size_t> g_TypeCount{0};
+        PointerSlot g_Pointers[kPointerSlots];
+        std::mutex g_InsertMutex;
+
+        Slot g_Slots[GameEventTrace::kCapacity];
+        std::atomic<uint64_t> g_Head{0};
+
+        GameEventRate g_LastSecond[GameEventTrace::kMaxEventTypes];
+        size_t g_LastSecondCount = 0;
+        GameEventRate g_TotalsScratch[GameEventTrace::kMaxEventTypes];
+        std::chrono::steady_clock::time_point g_LastAdvance;
+        bool g_AdvanceStarted = false;
+
+        size_t PointerHash(const char *name) {
+            return (reinterpret_cast<uintptr_t>(name) >> 3) * 0x9E3779B97F4A7C15ull >> 52;
+        }
+
+        // The engine hands out the same name pointer for every fire of an event type, so the string is only hashed
+        // the first time a pointer is seen.
+        EventType *FindType(const char *name) {
+            size_t slot = PointerHash(name) % kPointerSlots;
+            for (size_t probe = 0; probe < kPointerSlots; ++probe, slot = (slot + 1) % kPointerSlots) {
+                const char *key = g_Pointers[slot].name.load(std::memory_order_acquire);
+                if (key == name)
+                    return &g_Types[g_Pointers[slot].type];
+                if (!key)
+                    break;
+            }
+
+            std::lock_guard lock(g_InsertMutex);
+
+            const uint32_t nameId = NameTable::Intern(name, std::strlen(name));
+            if (nameId == NameTable::kInvalidId)
+                return nullptr;
+
+            const size_t count = g_TypeCount.load(std::memory_order_relaxed);
+            size_t type = std::find_if(g_Types, g_Types + count, [&](const EventType &entry) {
+                return entry.nameId == nameId;
+            }) - g_Types;
+            if (type == count) {
+                if (count == GameEventTrace::kMaxEventTypes)
+                    return nullptr;
+                g_Types[type].nameId = nameId;
+                g_TypeCount.store(count + 1, std::memory_order_release);
+            }
+
+            slot = PointerHash(name) % kPointerSlots;
+            for (size_t probe = 0; probe < kPointerSlots; ++probe, slot = (slot + 1) % kPointerSlots) {
+                const char *key = g_Pointers[slot].name.load(std::memory_order_relaxed);
+                if (key == name)
+                    break;
+                if (!key) {
+                    g_Pointers[slot].type = static_cast<uint32_t>(type);
+                    g_Pointers[slot].name.store(name, std::memory_order_release);
+                    break;
+                }
+            }
+
+            return &g_Types[type];
+        }
+
+        bool ByFiresDesc(const GameEventRate &a, const GameEventRate &b) { return a.fires > b.fires; }
+    }
+
+    void GameEventTrace::Record(const char *name) {
+        if (!name)
+            return;
+
+        EventType *type = FindType(name);
+        if (!type)
+            return;
+        type->fires.fetch_add(1, std::memory_order_relaxed);
+
+        const uint64_t index = g_Head.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = g_Slots[index % kCapacity];
+
+        slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.record = {MonotonicNs(), g_ServerTick.load(std::memory_order_relaxed), type->nameId};
+
+        slot.seq.store(2 * index + 2, std::memory_order_release);
+    }
+
+    void GameEventTrace::Advance() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!g_AdvanceStarted) {
+            g_AdvanceStarted = true;
+            g_LastAdvance = now;
+            return;
+        }
+        if (now - g_LastAdvance < std::chrono::seconds(1))
+            return;
+        g_LastAdvance = now;
+
+        const size_t count = g_TypeCount.load(std::memory_order_acquire);
+        size_t active = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t fires = g_Types[i].fires.load(std::memory_order_relaxed);
+            if (fires != g_Types[i].previousFires)
+                g_LastSecond[active++] = {g_Types[i].nameId, fires - g_Types[i].previousFires};
+            g_Types[i].previousFires = fires;
+        }
+
+        std::sort(g_LastSecond, g_LastSecond + active, ByFiresDesc);
+        g_LastSecondCount = active;
+    }
+
+    size_t GameEventTrace::LastSecond(GameEventRate *out, size_t max) {
+        const size_t count = std::min(g_LastSecondCount, max);
+        std::copy_n(g_LastSecond, count, out);
+        return count;
+    }
+
+    size_t GameEventTrace::Totals(GameEventRate *out, size_t max) {
+        const size_t types = g_TypeCount.load(std::memory_order_acquire);
+        for (size_t i = 0; i < types; ++i)
+            g_TotalsScratch[i] = {g_Types[i].nameId, g_Types[i].fires.load(std::memory_order_relaxed)};
+
+        const size_t count = std::min(types, max);
+        std::partial_sort(g_TotalsScratch, g_TotalsScratch + count, g_TotalsScratch + types, ByFiresDesc);
+        std::copy_n(g_TotalsScratch, count, out);
+        return count;
+    }
+
+    size_t GameEventTrace::Recent(GameEventRecord *out, size_t max) {
+        const uint64_t head = g_Head.load(std::memory_order_acquire);
+        const uint64_t available = std::min<uint64_t>(head, kCapacity);
+        size_t written = 0;
+
+        for (uint64_t newest = 0; newest < available && written < max; ++newest) {
+            const uint64_t index = head - 1 - newest;
+            const Slot &slot = g_Slots[index % kCapacity];
+
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before != 2 * index + 2)
+                continue;
+
+            out[written] = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before)
+                ++written;
+        }
+
+        return written;
+    }
+}
@@ -0,0 +1,42 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct GameEventRecord {
+        uint64_t timestampNs;
+        uint64_t tick;
+        uint32_t nameId;
+    };
+
+    struct GameEventRate {
+        uint32_t nameId;
+        uint64_t fires;
+    };
+
+    // Counts fired game events by name. Each event name is interned once and then found by its pointer, so the
+    // hot path is a pointer probe, an atomic increment and a push into a small lock-free ring.
+    class GameEventTrace {
+    public:
+        static constexpr size_t kCapacity = 512;
+        static constexpr size_t kMaxEventTypes = 1024;
+
+        static void Record(const char *name);
+
+        static void Advance();
+
+        // Event types fired during the last completed second, sorted by count.
+        static size_t LastSecond(GameEventRate *out, size_t max);
+
+        // Event types sorted by the number of fires since the plugin was loaded.
+        static size_t Totals(GameEventRate *out, size_t max);
+
+        // Copies up to max records into out, newest first.
+        static size_t Recent(GameEventRecord *out, size_t max);
+    };
+}
@@ -0,0 +1,53 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "gamedata.h"
+#include "log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+
+namespace acceleratorcss {
+    namespace {
+#if defined(_WIN32)
+        constexpr const char *kPlatform = "windows";
+#else
+        constexpr const char *kPlatform = "linux";
+#endif
+
+        nlohmann::json g_GameData;
+    }
+
+    bool GameData::Load(const std::string &path) {
+        try {
+            std::ifstream file(path);
+            if (!file.is_open()) {
+                ACC_CORE_WARN("Could not open gamedata: {}", path);
+                return false;
+            }
+
+            file >> g_GameData;
+            ACC_CORE_INFO("Gamedata loaded: {}", path);
+            return true;
+        } catch (const std::exception &e) {
+            ACC_CORE_ERROR("Failed to parse gamedata: {}", e.what());
+            g_GameData = nlohmann::json();
+            return false;
+        }
+    }
+
+    int GameData::Offset(const char *name) {
+        if (!g_GameData.is_object() || !g_GameData.contains(name))
+            return -1;
+
+        const auto &offsets = g_GameData[name].value("offsets", nlohmann::json::object());
+        if (!offsets.contains(kPlatform) || !offsets[kPlatform].is_number_integer()) {
+            ACC_CORE_WARN("Gamedata has no {} offset for {}", kPlatform, name);
+            return -1;
+        }
+
+        return offsets[kPlatform].get<int>();
+    }
+}
@@ -0,0 +1,18 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <string>
+
+namespace acceleratorcss {
+    // Engine offsets that change between game updates, kept in gamedata.json so they can be fixed without a rebuild.
+    class GameData {
+    public:
+        static bool Load(const std::string &path);
+
+        // Offset for the current platform, or -1 if gamedata.json does not have it.
+        static int Offset(const char *name);
+    };
+}
@@ -0,0 +1,123 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "helper_threads.h"
+#include "log.h"
+#include "timing.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+namespace acceleratorcss {
+    namespace {
+        HelperThreadConfig g_Config;
+        cpu_set_t g_Cpus;
+        bool g_Pin = false;
+
+        bool ParseCpuList(const std::string &list, cpu_set_t &out) {
+            CPU_ZERO(&out);
+
+            const char *cursor = list.c_str();
+            while (*cursor) {
+                char *end = nullptr;
+                const long first = std::strtol(cursor, &end, 10);
+                if (end == cursor || first < 0 || first >= CPU_SETSIZE)
+                    return false;
+
+                long last = first;
+                cursor = end;
+                if (*cursor == '-') {
+                    last = std::strtol(cursor + 1, &end, 10);
+                    if (end == cursor + 1 || last < first || last >= CPU_SETSIZE)
+                        return false;
+                    cursor = end;
+                }
+
+                for (long cpu = first; cpu <= last; ++cpu)
+                    CPU_SET(cpu, &out);
+
+                while (*cursor == ',' || *cursor == ' ')
+                    ++cursor;
+            }
+
+            return CPU_COUNT(&out) > 0;
+        }
+
+        std::string FormatCpuList(const cpu_set_t &cpus) {
+            std::string list;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (!CPU_ISSET(cpu, &cpus))
+                    continue;
+                if (!list.empty())
+                    list += ',';
+                list += std::to_string(cpu);
+            }
+            return list;
+        }
+
+        const char *PolicyName(HelperThreadPolicy policy) {
+            switch (policy) {
+                case HelperThreadPolicy::Batch:
+                    return "SCHED_BATCH";
+                case HelperThreadPolicy::Idle:
+                    return "SCHED_IDLE";
+                default:
+                    return "SCHED_OTHER";
+            }
+        }
+    }
+
+    void HelperThreads::Configure(const HelperThreadConfig &config) {
+        g_Config = config;
+        g_Pin = false;
+
+        if (!config.cpus.empty()) {
+            cpu_set_t requested;
+            cpu_set_t allowed;
+            if (!ParseCpuList(config.cpus, requested)) {
+                ACC_CORE_WARN("Invalid HelperThreadCpus '{}', helper threads are not pinned.", config.cpus);
+            } else if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+                ACC_CORE_WARN("Failed to read the server's CPU affinity, helper threads are not pinned.");
+            } else {
+                // CPUs outside the server's own set (cgroup cpuset, taskset) would be rejected by the kernel anyway.
+                CPU_AND(&g_Cpus, &requested, &allowed);
+                g_Pin = CPU_COUNT(&g_Cpus) > 0;
+                if (!g_Pin)
+                    ACC_CORE_WARN("None of HelperThreadCpus '{}' are available to the server (allowed: {}), helper "
+                                  "threads are not pinned.", config.cpus, FormatCpuList(allowed));
+            }
+        }
+
+        ACC_CORE_INFO("Helper threads: CPUs {}, {}{}", g_Pin ? FormatCpuList(g_Cpus) : "inherited",
+                      PolicyName(config.policy),
+                      config.policy == HelperThreadPolicy::Idle ? "" : fmt::format(", nice {}", config.nice));
+    }
+
+    void HelperThreads::Enter(const char *name) {
+        char threadName[16];
+        std::snprintf(threadName, sizeof(threadName), "acc-%s", name);
+        pthread_setname_np(pthread_self(), threadName);
+
+        if (g_Pin && pthread_setaffinity_np(pthread_self(), sizeof(g_Cpus), &g_Cpus) != 0)
+            ACC_CORE_WARN("Failed to pin helper thread {} to CPUs {}.", threadName, FormatCpuList(g_Cpus));
+
+        sched_param param{};
+        const int policy = g_Config.policy == HelperThreadPolicy::Idle    ? SCHED_IDLE
+                           : g_Config.policy == HelperThreadPolicy::Batch ? SCHED_BATCH
+                                                                          : SCHED_OTHER;
+        if (pthread_setschedparam(pthread_self(), policy, &param) != 0)
+            ACC_CORE_WARN("Failed to set {} for helper thread {}.", PolicyName(g_Config.policy), threadName);
+
+        // Nice values are per thread on Linux, raising them needs no privileges.
+        if (g_Config.policy != HelperThreadPolicy::Idle && g_Config.nice != 0 &&
+            setpriority(PRIO_PROCESS, static_cast<id_t>(CurrentThreadId()), g_Config.nice) != 0)
+            ACC_CORE_WARN("Failed to set nice {} for helper thread {}: {}", g_Config.nice, threadName,
+                          std::strerror(errno));
+    }
+}
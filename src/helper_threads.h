@@ -0,0 +1,35 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <string>
+
+namespace acceleratorcss {
+    enum class HelperThreadPolicy {
+        Normal,
+        Batch,
+        Idle,
+    };
+
+    struct HelperThreadConfig {
+        // CPU list such as "3" or "2-3,6". Empty keeps the affinity inherited from the server.
+        std::string cpus;
+        HelperThreadPolicy policy = HelperThreadPolicy::Batch;
+        // Ignored for SCHED_IDLE.
+        int nice = 10;
+    };
+
+    // Placement of the plugin's own background threads (uploader, trackers, monitors, exporters), so they stay off
+    // the game thread's core and lose every scheduling decision against it.
+    class HelperThreads {
+    public:
+        // Validates the config against the CPUs the process may use and logs what will be applied. Must run before
+        // the first helper thread is started.
+        static void Configure(const HelperThreadConfig &config);
+
+        // Called first by every helper thread: names it "acc-<name>" and applies the CPU set and scheduling policy.
+        static void Enter(const char *name);
+    };
+}
@@ -0,0 +1,167 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "memory_tracker.h"
+#include "helper_threads.h"
+#include "log.h"
+#include "tick_stats.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr double kMb = 1024.0 * 1024.0;
+
+        // Single writer (the tracker thread), readers only look at samples below g_Count.
+        MemorySample g_Samples[MemoryTracker::kCapacity];
+        std::atomic<uint64_t> g_Count{0};
+
+        MemoryTrackerConfig g_Config;
+        std::thread g_Thread;
+        std::mutex g_Mutex;
+        std::condition_variable g_Wake;
+        bool g_Stopping = false;
+
+        // Only touched by the tracker thread, kept for the rare sample where ReadGc keeps racing a publish.
+        uint64_t g_LastManagedHeapBytes = 0;
+
+        uint64_t ReadStatmRss() {
+            FILE *file = std::fopen("/proc/self/statm", "r");
+            if (!file)
+                return 0;
+
+            unsigned long long size = 0;
+            unsigned long long resident = 0;
+            const int read = std::fscanf(file, "%llu %llu", &size, &resident);
+            std::fclose(file);
+
+            return read == 2 ? resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+        }
+
+        void ReadSmapsRollup(MemorySample &sample) {
+            FILE *file = std::fopen("/proc/self/smaps_rollup", "r");
+            if (!file)
+                return;
+
+            char line[256];
+            while (std::fgets(line, sizeof(line), file)) {
+                unsigned long long kb = 0;
+                if (std::sscanf(line, "Rss: %llu kB", &kb) == 1)
+                    sample.rssBytes = kb * 1024;
+                else if (std::sscanf(line, "Pss: %llu kB", &kb) == 1)
+                    sample.pssBytes = kb * 1024;
+                else if (std::sscanf(line, "Anonymous: %llu kB", &kb) == 1)
+                    sample.anonymousBytes = kb * 1024;
+            }
+            std::fclose(file);
+        }
+
+        MemorySample TakeSample() {
+            MemorySample sample{};
+            sample.timestampNs = MonotonicNs();
+            sample.tick = g_ServerTick.load(std::memory_order_relaxed);
+            sample.rssBytes = ReadStatmRss();
+            // smaps_rollup is more expensive but also gives PSS and anonymous memory, statm stays the fallback.
+            ReadSmapsRollup(sample);
+            GcSnapshot gc{};
+            if (TickStats::ReadGc(gc))
+                g_LastManagedHeapBytes = gc.heapSizeBytes;
+            sample.managedHeapBytes = g_LastManagedHeapBytes;
+            return sample;
+        }
+
+        void CheckGrowth(uint64_t count, uint64_t &lastWarningNs) {
+            const uint64_t windowSamples = static_cast<uint64_t>(g_Config.windowMinutes) * 60 / g_Config.intervalSec;
+            if (windowSamples == 0 || count <= windowSamples)
+                return;
+
+            const MemorySample &now = g_Samples[(count - 1) % MemoryTracker::kCapacity];
+            const MemorySample &then = g_Samples[(count - 1 - windowSamples) % MemoryTracker::kCapacity];
+            const double minutes = static_cast<double>(now.timestampNs - then.timestampNs) / 60e9;
+            if (minutes <= 0.0)
+                return;
+
+            const double rssRate = (static_cast<double>(now.rssBytes) - static_cast<double>(then.rssBytes)) / kMb / minutes;
+            if (rssRate < g_Config.warnMbPerMinute)
+                return;
+
+            // One warning per window, the growth rate is already averaged over it.
+            if (lastWarningNs && now.timestampNs - lastWarningNs < static_cast<uint64_t>(g_Config.windowMinutes) * 60'000'000'000ull)
+                return;
+            lastWarningNs = now.timestampNs;
+
+            const double managedRate =
+                (static_cast<double>(now.managedHeapBytes) - static_cast<double>(then.managedHeapBytes)) / kMb / minutes;
+            ACC_CORE_WARN("Memory is growing by {:.1f} MB/min over the last {} min (managed heap {:+.1f} MB/min, "
+                          "native and other {:+.1f} MB/min), RSS now {:.0f} MB",
+                          rssRate, g_Config.windowMinutes, managedRate, rssRate - managedRate,
+                          static_cast<double>(now.rssBytes) / kMb);
+        }
+
+        void TrackerLoop() {
+            HelperThreads::Enter("memory");
+            uint64_t lastWarningNs = 0;
+            std::unique_lock lock(g_Mutex);
+
+            while (!g_Stopping) {
+                lock.unlock();
+                const uint64_t count = g_Count.load(std::memory_order_relaxed);
+                g_Samples[count % MemoryTracker::kCapacity] = TakeSample();
+                g_Count.store(count + 1, std::memory_order_release);
+                CheckGrowth(count + 1, lastWarningNs);
+                lock.lock();
+
+                g_Wake.wait_for(lock, std::chrono::seconds(g_Config.intervalSec), [] { return g_Stopping; });
+            }
+        }
+    }
+
+    bool MemoryTracker::Start(const MemoryTrackerConfig &config) {
+        std::lock_guard lock(g_Mutex);
+        if (g_Thread.joinable() || config.intervalSec <= 0)
+            return false;
+
+        g_Config = config;
+        g_Config.windowMinutes = std::max(1, g_Config.windowMinutes);
+
+        // The oldest sample of the window has to still be in the ring.
+        const int maxWindowMinutes = static_cast<int>((kCapacity - 1) * static_cast<size_t>(config.intervalSec) / 60);
+        if (g_Config.windowMinutes > maxWindowMinutes) {
+            ACC_CORE_WARN("MemoryGrowthWindowMinutes {} needs more than {} samples at {}s intervals, using {} min.",
+                          g_Config.windowMinutes, kCapacity - 1, config.intervalSec, maxWindowMinutes);
+            g_Config.windowMinutes = maxWindowMinutes;
+        }
+        g_Stopping = false;
+        g_Thread = std::thread(TrackerLoop);
+        return true;
+    }
+
+    void MemoryTracker::Stop() {
+        {
+            std::lock_guard lock(g_Mutex);
+            g_Stopping = true;
+        }
+        g_Wake.notify_all();
+
+        if (g_Thread.joinable())
+            g_Thread.join();
+    }
+
+    size_t MemoryTracker::Recent(MemorySample *out, size_t max) {
+        const uint64_t count = g_Count.load(std::memory_order_acquire);
+        // The slot the tracker writes next is the oldest one, so it is left out.
+        const size_t available = std::min<uint64_t>({count, kCapacity - 1, max});
+        for (size_t i = 0; i < available; ++i)
+            out[i] = g_Samples[(count - 1 - i) % kCapacity];
+        return available;
+    }
+}
@@ -0,0 +1,39 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct MemoryTrackerConfig {
+        int intervalSec = 10;
+        int windowMinutes = 10;
+        int warnMbPerMinute = 20;
+    };
+
+    struct MemorySample {
+        uint64_t timestampNs;
+        uint64_t tick;
+        uint64_t rssBytes;
+        uint64_t pssBytes;
+        uint64_t anonymousBytes;
+        uint64_t managedHeapBytes;
+    };
+
+    // Samples process memory (statm, smaps_rollup) and the managed heap size on a helper thread and warns when
+    // RSS grows faster than the configured rate over the window, split into managed and native growth.
+    class MemoryTracker {
+    public:
+        static constexpr size_t kCapacity = 512;
+
+        static bool Start(const MemoryTrackerConfig &config);
+
+        static void Stop();
+
+        // Copies up to max samples into out, newest first. Safe to call from the crash handler.
+        static size_t Recent(MemorySample *out, size_t max);
+    };
+}
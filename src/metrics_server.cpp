@@ -0,0 +1,342 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "metrics_server.h"
+#include "callback_stats.h"
+#include "helper_threads.h"
+#include "log.h"
+#include "memory_tracker.h"
+#include "names.h"
+#include "tick_stats.h"
+#include "timing.h"
+#include "trace_governor.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <iterator>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string_view>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr size_t kTopCallbacks = 20;
+        constexpr int kRequestTimeoutMs = 2000;
+        constexpr size_t kMaxRequestBytes = 4096;
+
+        MetricsServerConfig g_Config;
+        std::mutex g_Mutex;
+        std::thread g_Thread;
+        int g_StopFd = -1;
+        int g_ListenFd = -1;
+
+        struct CrashCounts {
+            uint32_t minidumps = 0;
+            uint32_t unclean = 0;
+        };
+
+        time_t BootTime() {
+            FILE *file = std::fopen("/proc/stat", "r");
+            if (!file)
+                return 0;
+
+            char line[256];
+            long long btime = 0;
+            while (std::fgets(line, sizeof(line), file)) {
+                if (std::sscanf(line, "btime %lld", &btime) == 1)
+                    break;
+            }
+            std::fclose(file);
+            return static_cast<time_t>(btime);
+        }
+
+        bool EndsWith(const char *name, const char *suffix) {
+            const size_t nameLen = std::strlen(name);
+            const size_t suffixLen = std::strlen(suffix);
+            return nameLen >= suffixLen && std::strcmp(name + nameLen - suffixLen, suffix) == 0;
+        }
+
+        // Files from before the last host boot belong to an earlier life of the machine and are not counted. Only dumps
+        // with the crash handler's .txt report are crashes, pressure_*.dmp comes from a server that kept running.
+        CrashCounts CountCrashes() {
+            CrashCounts counts;
+            DIR *dir = opendir(g_Config.logsDirectory.c_str());
+            if (!dir)
+                return counts;
+
+            const time_t boot = BootTime();
+            while (const dirent *entry = readdir(dir)) {
+                const bool minidump = EndsWith(entry->d_name, ".dmp");
+                const bool unclean = std::strncmp(entry->d_name, "unclean_", 8) == 0 && EndsWith(entry->d_name, ".txt");
+                if (!minidump && !unclean)
+                    continue;
+
+                struct stat info{};
+                const std::string path = g_Config.logsDirectory + "/" + entry->d_name;
+                if (stat(path.c_str(), &info) != 0 || info.st_mtime < boot)
+                    continue;
+                if (minidump && access((path + ".txt").c_str(), F_OK) != 0)
+                    continue;
+
+                if (minidump)
+                    counts.minidumps++;
+                else
+                    counts.unclean++;
+            }
+            closedir(dir);
+            return counts;
+        }
+
+        void EscapeLabel(std::string &out, const char *value) {
+            for (const char *c = value; *c; ++c) {
+                if (*c == '\\')
+                    out += "\\\\";
+                else if (*c == '"')
+                    out += "\\\"";
+                else if (*c == '\n')
+                    out += "\\n";
+                else
+                    out += *c;
+            }
+        }
+
+        void Header(std::string &out, const char *name, const char *type, const char *help) {
+            fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+        }
+
+        std::string Render() {
+            std::string out;
+            out.reserve(8192);
+            auto it = std::back_inserter(out);
+
+            Header(out, "acceleratorcss_server_tick", "gauge", "Server frames since the plugin was loaded.");
+            fmt::format_to(it, "acceleratorcss_server_tick {}\n", g_ServerTick.load(std::memory_order_relaxed));
+
+            TickHistogram ticks;
+            TickStats::ReadTickHistogram(ticks);
+            Header(out, "acceleratorcss_tick_duration_seconds", "histogram", "Time between two server frames.");
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < TickHistogram::kBuckets; ++i) {
+                cumulative += ticks.buckets[i];
+                const uint64_t limitUs = TickStats::TickBucketLimitUs(i);
+                if (limitUs)
+                    fmt::format_to(it, "acceleratorcss_tick_duration_seconds_bucket{{le=\"{}\"}} {}\n",
+                                   static_cast<double>(limitUs) / 1e6, cumulative);
+                else
+                    fmt::format_to(it, "acceleratorcss_tick_duration_seconds_bucket{{le=\"+Inf\"}} {}\n", cumulative);
+            }
+            fmt::format_to(it, "acceleratorcss_tick_duration_seconds_sum {}\n", static_cast<double>(ticks.sumNs) / 1e9);
+            fmt::format_to(it, "acceleratorcss_tick_duration_seconds_count {}\n", ticks.count);
+
+            CallbackRate top[kTopCallbacks];
+            uint64_t totalCalls = 0;
+            const size_t topCount = CallbackStats::Totals(top, kTopCallbacks, totalCalls);
+            Header(out, "acceleratorcss_callback_calls_total", "counter", "C# callbacks traced since load.");
+            fmt::format_to(it, "acceleratorcss_callback_calls_total {}\n", totalCalls);
+            Header(out, "acceleratorcss_callback_method_calls_total", "counter",
+                   "Calls of the most called C# callbacks since load.");
+            for (size_t i = 0; i < topCount; ++i) {
+                out += "acceleratorcss_callback_method_calls_total{method=\"";
+                EscapeLabel(out, NameTable::Get(top[i].methodId));
+                fmt::format_to(it, "\"}} {}\n", top[i].calls);
+            }
+
+            const TraceOverheadTotals overhead = TraceGovernor::Totals();
+            Header(out, "acceleratorcss_trace_level", "gauge", "Current trace level: 0 full, 1 lightweight, 2 sampled.");
+            fmt::format_to(it, "acceleratorcss_trace_level {}\n", static_cast<int>(TraceGovernor::Level()));
+            Header(out, "acceleratorcss_trace_overhead_seconds_total", "counter",
+                   "Time spent tracing callbacks, the managed side includes the native calls it makes.");
+            fmt::format_to(it, "acceleratorcss_trace_overhead_seconds_total{{side=\"managed\"}} {}\n",
+                           static_cast<double>(overhead.managedNs) / 1e9);
+            fmt::format_to(it, "acceleratorcss_trace_overhead_seconds_total{{side=\"native\"}} {}\n",
+                           static_cast<double>(overhead.nativeNs) / 1e9);
+            Header(out, "acceleratorcss_trace_frame_seconds_total", "counter",
+                   "Frame time the trace overhead is measured against.");
+            fmt::format_to(it, "acceleratorcss_trace_frame_seconds_total {}\n", static_cast<double>(overhead.frameNs) / 1e9);
+            Header(out, "acceleratorcss_trace_level_changes_total", "counter", "Trace level changes by the governor.");
+            fmt::format_to(it, "acceleratorcss_trace_level_changes_total {}\n", overhead.levelChanges);
+
+            const CrashCounts crashes = CountCrashes();
+            Header(out, "acceleratorcss_crashes_since_boot", "gauge", "Crash reports written since the host booted.");
+            fmt::format_to(it, "acceleratorcss_crashes_since_boot {}\n", crashes.minidumps);
+            Header(out, "acceleratorcss_unclean_shutdowns_since_boot", "gauge",
+                   "Server processes killed without a crash report (SIGKILL, OOM) since the host booted.");
+            fmt::format_to(it, "acceleratorcss_unclean_shutdowns_since_boot {}\n", crashes.unclean);
+
+            MemorySample memory{};
+            if (MemoryTracker::Recent(&memory, 1) == 1) {
+                Header(out, "acceleratorcss_memory_bytes", "gauge", "Latest memory tracker sample.");
+                fmt::format_to(it, "acceleratorcss_memory_bytes{{kind=\"rss\"}} {}\n", memory.rssBytes);
+                fmt::format_to(it, "acceleratorcss_memory_bytes{{kind=\"pss\"}} {}\n", memory.pssBytes);
+                fmt::format_to(it, "acceleratorcss_memory_bytes{{kind=\"anonymous\"}} {}\n", memory.anonymousBytes);
+                fmt::format_to(it, "acceleratorcss_memory_bytes{{kind=\"managed_heap\"}} {}\n", memory.managedHeapBytes);
+            }
+
+            GcSnapshot gc{};
+            if (TickStats::ReadGc(gc)) {
+                Header(out, "acceleratorcss_gc_collections_total", "counter", "Managed GC collections by generation.");
+                fmt::format_to(it, "acceleratorcss_gc_collections_total{{generation=\"0\"}} {}\n", gc.gen0Collections);
+                fmt::format_to(it, "acceleratorcss_gc_collections_total{{generation=\"1\"}} {}\n", gc.gen1Collections);
+                fmt::format_to(it, "acceleratorcss_gc_collections_total{{generation=\"2\"}} {}\n", gc.gen2Collections);
+                Header(out, "acceleratorcss_gc_pause_seconds_total", "counter", "Time the runtime was paused for GC.");
+                fmt::format_to(it, "acceleratorcss_gc_pause_seconds_total {}\n", static_cast<double>(gc.totalPauseNs) / 1e9);
+                Header(out, "acceleratorcss_gc_last_pause_seconds", "gauge", "Duration of the most recent GC pause.");
+                fmt::format_to(it, "acceleratorcss_gc_last_pause_seconds {}\n", static_cast<double>(gc.lastPauseNs) / 1e9);
+                Header(out, "acceleratorcss_gc_allocated_bytes_total", "counter", "Bytes allocated by managed code.");
+                fmt::format_to(it, "acceleratorcss_gc_allocated_bytes_total {}\n", gc.allocatedBytes);
+                Header(out, "acceleratorcss_gc_heap_bytes", "gauge", "Managed heap size after the last collection.");
+                fmt::format_to(it, "acceleratorcss_gc_heap_bytes {}\n", gc.heapSizeBytes);
+                Header(out, "acceleratorcss_gc_fragmented_bytes", "gauge", "Free space inside the managed heap.");
+                fmt::format_to(it, "acceleratorcss_gc_fragmented_bytes {}\n", gc.fragmentedBytes);
+            }
+
+            return out;
+        }
+
+        void SendAll(int fd, const char *data, size_t len) {
+            while (len > 0) {
+                const ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR)
+                    continue;
+                if (sent <= 0)
+                    return;
+                data += sent;
+                len -= static_cast<size_t>(sent);
+            }
+        }
+
+        void Respond(int fd, const char *status, const std::string &body) {
+            const std::string head = fmt::format("HTTP/1.1 {}\r\nContent-Type: text/plain; version=0.0.4; "
+                                                 "charset=utf-8\r\nContent-Length: {}\r\nConnection: close\r\n\r\n",
+                                                 status, body.size());
+            SendAll(fd, head.data(), head.size());
+            SendAll(fd, body.data(), body.size());
+        }
+
+        // One request per connection, scrapers open a new one every interval anyway.
+        void Serve(int fd) {
+            char request[kMaxRequestBytes];
+            size_t used = 0;
+            while (used < sizeof(request) - 1) {
+                pollfd pfd{fd, POLLIN, 0};
+                if (poll(&pfd, 1, kRequestTimeoutMs) <= 0)
+                    return;
+
+                const ssize_t read = recv(fd, request + used, sizeof(request) - 1 - used, 0);
+                if (read <= 0)
+                    return;
+                used += static_cast<size_t>(read);
+                request[used] = '\0';
+                if (std::strstr(request, "\r\n\r\n"))
+                    break;
+            }
+            request[used] = '\0';
+
+            if (std::strncmp(request, "GET ", 4) != 0) {
+                Respond(fd, "405 Method Not Allowed", "Only GET is supported.\n");
+                return;
+            }
+
+            const char *path = request + 4;
+            const size_t pathLen = std::strcspn(path, " ?\r\n");
+            if (std::string_view(path, pathLen) != "/metrics") {
+                Respond(fd, "404 Not Found", "Metrics are served on /metrics.\n");
+                return;
+            }
+
+            Respond(fd, "200 OK", Render());
+        }
+
+        void ServerLoop() {
+            HelperThreads::Enter("metrics");
+
+            while (true) {
+                pollfd fds[2] = {{g_StopFd, POLLIN, 0}, {g_ListenFd, POLLIN, 0}};
+                if (poll(fds, 2, -1) < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    ACC_CORE_ERROR("Metrics endpoint poll failed: {}", std::strerror(errno));
+                    return;
+                }
+                if (fds[0].revents)
+                    return;
+                if (!(fds[1].revents & POLLIN))
+                    continue;
+
+                const int client = accept4(g_ListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client < 0)
+                    continue;
+                Serve(client);
+                close(client);
+            }
+        }
+    }
+
+    bool MetricsServer::Start(const MetricsServerConfig &config) {
+        std::lock_guard lock(g_Mutex);
+        if (g_Thread.joinable() || config.port <= 0 || config.port > 65535)
+            return false;
+
+        g_Config = config;
+
+        g_ListenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (g_ListenFd < 0) {
+            ACC_CORE_WARN("Failed to create the metrics socket: {}", std::strerror(errno));
+            return false;
+        }
+
+        const int reuse = 1;
+        setsockopt(g_ListenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        // Loopback only, the endpoint has no authentication. Expose it through the node's exporter or a proxy.
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(config.port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(g_ListenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            listen(g_ListenFd, 8) != 0) {
+            ACC_CORE_WARN("Failed to listen on 127.0.0.1:{} for metrics: {}", config.port, std::strerror(errno));
+            close(g_ListenFd);
+            g_ListenFd = -1;
+            return false;
+        }
+
+        g_StopFd = eventfd(0, EFD_CLOEXEC);
+        if (g_StopFd < 0) {
+            close(g_ListenFd);
+            g_ListenFd = -1;
+            return false;
+        }
+
+        g_Thread = std::thread(ServerLoop);
+        ACC_CORE_INFO("Metrics endpoint listening on http://127.0.0.1:{}/metrics", config.port);
+        return true;
+    }
+
+    void MetricsServer::Stop() {
+        std::lock_guard lock(g_Mutex);
+        if (!g_Thread.joinable())
+            return;
+
+        const uint64_t one = 1;
+        if (write(g_StopFd, &one, sizeof(one)) < 0)
+            ACC_CORE_WARN("Failed to signal the metrics endpoint.");
+        g_Thread.join();
+
+        close(g_StopFd);
+        g_StopFd = -1;
+        close(g_ListenFd);
+        g_ListenFd = -1;
+    }
+}
@@ -0,0 +1,25 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <string>
+
+namespace acceleratorcss {
+    struct MetricsServerConfig {
+        // Port on 127.0.0.1, 0 disables the endpoint.
+        int port = 0;
+        // Minidumps and unclean shutdown reports in here are counted for the since-boot gauges.
+        std::string logsDirectory;
+    };
+
+    // Prometheus text endpoint (GET /metrics) on a helper thread. Everything a scrape reads is an atomic counter or a
+    // sequence-checked copy, so the game thread never waits for a scrape and a scrape never waits for the game thread.
+    class MetricsServer {
+    public:
+        static bool Start(const MetricsServerConfig &config);
+
+        static void Stop();
+    };
+}
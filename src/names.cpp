@@ -0,0 +1,186 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "names.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr uint32_t kSlotCount = NameTable::kMaxNames * 2;
+        constexpr uint32_t kFileMagic = 0x4e434341; // "ACCN"
+        constexpr uint32_t kFileVersion = 1;
+
+        // Names are stored back to back in id order, so the pool alone is enough to rebuild the table.
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t count;
+            uint32_t reserved;
+            uint64_t used;
+        };
+
+        // Slot values are id + 1, zero marks an empty slot.
+        std::atomic<uint32_t> g_Slots[kSlotCount];
+        std::atomic<const char *> g_Names[NameTable::kMaxNames];
+        uint64_t g_Hashes[NameTable::kMaxNames];
+        std::atomic<uint32_t> g_Count{0};
+
+        char g_StaticPool[NameTable::kPoolSize];
+        char *g_Pool = g_StaticPool;
+        FileHeader *g_File = nullptr;
+        size_t g_PoolUsed = 0;
+        std::mutex g_InternMutex;
+
+        uint64_t Hash(const char *str, size_t len) {
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < len; ++i) {
+                hash ^= static_cast<unsigned char>(str[i]);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        uint32_t Probe(const char *str, size_t len, uint64_t hash, uint32_t &slot) {
+            slot = static_cast<uint32_t>(hash) & (kSlotCount - 1);
+
+            for (uint32_t i = 0; i < kSlotCount; ++i, slot = (slot + 1) & (kSlotCount - 1)) {
+                uint32_t value = g_Slots[slot].load(std::memory_order_acquire);
+                if (value == 0)
+                    return NameTable::kInvalidId;
+
+                uint32_t id = value - 1;
+                const char *name = g_Names[id].load(std::memory_order_acquire);
+                if (g_Hashes[id] == hash && std::strncmp(name, str, len) == 0 && name[len] == '\0')
+                    return id;
+            }
+
+            return NameTable::kInvalidId;
+        }
+    }
+
+    uint32_t NameTable::Intern(const char *str, size_t len) {
+        if (!str)
+            return kInvalidId;
+
+        const uint64_t hash = Hash(str, len);
+        uint32_t slot;
+
+        uint32_t id = Probe(str, len, hash, slot);
+        if (id != kInvalidId)
+            return id;
+
+        std::lock_guard lock(g_InternMutex);
+
+        // Another thread may have inserted the same name while we were waiting for the lock.
+        id = Probe(str, len, hash, slot);
+        if (id != kInvalidId)
+            return id;
+
+        id = g_Count.load(std::memory_order_relaxed);
+        if (id >= kMaxNames || g_PoolUsed + len + 1 > kPoolSize)
+            return kInvalidId;
+
+        char *name = g_Pool + g_PoolUsed;
+        std::memcpy(name, str, len);
+        name[len] = '\0';
+        g_PoolUsed += len + 1;
+
+        g_Hashes[id] = hash;
+        g_Names[id].store(name, std::memory_order_release);
+        g_Count.store(id + 1, std::memory_order_release);
+        g_Slots[slot].store(id + 1, std::memory_order_release);
+
+        if (g_File) {
+            g_File->used = g_PoolUsed;
+            g_File->count = id + 1;
+        }
+
+        return id;
+    }
+
+    uint32_t NameTable::Find(const char *str, size_t len) {
+        if (!str)
+            return kInvalidId;
+
+        uint32_t slot;
+        return Probe(str, len, Hash(str, len), slot);
+    }
+
+    const char *NameTable::Get(uint32_t id) {
+        if (id >= g_Count.load(std::memory_order_acquire))
+            return "[unknown]";
+
+        return g_Names[id].load(std::memory_order_acquire);
+    }
+
+    uint32_t NameTable::Count() {
+        return g_Count.load(std::memory_order_acquire);
+    }
+
+    bool NameTable::Persist(const std::string &path) {
+        std::lock_guard lock(g_InternMutex);
+        if (g_File)
+            return true;
+
+        // Unlinked first, a previous process may still have the old file mapped.
+        unlink(path.c_str());
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+
+        const size_t bytes = sizeof(FileHeader) + kPoolSize;
+        void *mapping = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+            mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        auto *file = static_cast<FileHeader *>(mapping);
+        char *pool = static_cast<char *>(mapping) + sizeof(FileHeader);
+        std::memcpy(pool, g_Pool, g_PoolUsed);
+        *file = {kFileMagic, kFileVersion, g_Count.load(std::memory_order_relaxed), 0, g_PoolUsed};
+
+        // Already interned names keep pointing into the static pool, only new ones land in the file.
+        g_Pool = pool;
+        g_File = file;
+        return true;
+    }
+
+    bool NameTable::ReadPersisted(const std::string &path, std::vector<std::string> &names) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        struct stat st{};
+        void *mapping = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(FileHeader))
+            mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        const auto *file = static_cast<const FileHeader *>(mapping);
+        const char *pool = static_cast<const char *>(mapping) + sizeof(FileHeader);
+        const size_t used = std::min<uint64_t>(file->used, st.st_size - sizeof(FileHeader));
+
+        const bool valid = file->magic == kFileMagic && file->version == kFileVersion;
+        for (size_t offset = 0; valid && names.size() < file->count && offset < used;) {
+            const size_t len = strnlen(pool + offset, used - offset);
+            names.emplace_back(pool + offset, len);
+            offset += len + 1;
+        }
+
+        munmap(mapping, st.st_size);
+        return valid;
+    }
+}
@@ -0,0 +1,36 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace acceleratorcss {
+    // Fixed-capacity string interning table shared by all tracers. Names are never removed, so an id stays valid
+    // for the lifetime of the process and Get() is lock-free and safe to call from the crash handler.
+    class NameTable {
+    public:
+        static constexpr uint32_t kInvalidId = 0xFFFFFFFFu;
+        static constexpr uint32_t kMaxNames = 32768;
+        static constexpr size_t kPoolSize = 4 * 1024 * 1024;
+
+        static uint32_t Intern(const char *str, size_t len);
+
+        static uint32_t Find(const char *str, size_t len);
+
+        static const char *Get(uint32_t id);
+
+        static uint32_t Count();
+
+        // Moves the string pool into a shared file mapping, so ids recorded in other persisted buffers can still be
+        // resolved after the process was killed. Names interned so far are copied over.
+        static bool Persist(const std::string &path);
+
+        // Reads the names of a pool persisted by a previous process, indexed by id.
+        static bool ReadPersisted(const std::string &path, std::vector<std::string> &names);
+    };
+}
@@ -0,0 +1,146 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "net_trace.h"
+#include "timing.h"
+
+#include "cs_gameevents.pb.h"
+#include "cstrike15_usermessages.pb.h"
+#include "gameevents.pb.h"
+#include "netmessages.pb.h"
+#include "networkbasetypes.pb.h"
+#include "te.pb.h"
+#include "usermessages.pb.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace acceleratorcss {
+    namespace {
+        struct Slot {
+            // 2 * index + 1 while the record is being written, 2 * index + 2 once it is published.
+            std::atomic<uint64_t> seq{0};
+            NetMessageRecord record;
+        };
+
+        Slot g_Slots[NetMessageTrace::kCapacity];
+        std::atomic<uint64_t> g_Head{0};
+
+        std::atomic<uint64_t> g_Counts[NetMessageTrace::kMaxMessageId];
+        std::atomic<uint64_t> g_Bytes[NetMessageTrace::kMaxMessageId];
+        uint64_t g_PreviousCounts[NetMessageTrace::kMaxMessageId];
+        uint64_t g_PreviousBytes[NetMessageTrace::kMaxMessageId];
+
+        NetMessageRate g_LastSecond[NetMessageTrace::kMaxMessageId];
+        size_t g_LastSecondCount = 0;
+        std::chrono::steady_clock::time_point g_LastAdvance;
+        bool g_AdvanceStarted = false;
+
+        const char *g_Names[NetMessageTrace::kMaxMessageId];
+
+        template<typename IsValid, typename NameOf>
+        void ResolveNames(IsValid isValid, NameOf nameOf) {
+            for (uint32_t id = 0; id < NetMessageTrace::kMaxMessageId; ++id) {
+                if (!g_Names[id] && isValid(static_cast<int>(id)))
+                    g_Names[id] = nameOf(static_cast<int>(id)).c_str();
+            }
+        }
+    }
+
+    void NetMessageTrace::Init() {
+        // Message id ranges of these enums do not overlap, the first match wins in case a future update adds one.
+        ResolveNames(NET_Messages_IsValid, [](int id) -> const std::string & { return NET_Messages_Name(id); });
+        ResolveNames(SVC_Messages_IsValid, [](int id) -> const std::string & { return SVC_Messages_Name(id); });
+        ResolveNames(Bidirectional_Messages_IsValid,
+                     [](int id) -> const std::string & { return Bidirectional_Messages_Name(id); });
+        ResolveNames(EBaseUserMessages_IsValid, [](int id) -> const std::string & { return EBaseUserMessages_Name(id); });
+        ResolveNames(EBaseEntityMessages_IsValid,
+                     [](int id) -> const std::string & { return EBaseEntityMessages_Name(id); });
+        ResolveNames(ECstrike15UserMessages_IsValid,
+                     [](int id) -> const std::string & { return ECstrike15UserMessages_Name(id); });
+        ResolveNames(EBaseGameEvents_IsValid, [](int id) -> const std::string & { return EBaseGameEvents_Name(id); });
+        ResolveNames(ECsgoGameEvents_IsValid, [](int id) -> const std::string & { return ECsgoGameEvents_Name(id); });
+        ResolveNames(ETEProtobufIds_IsValid, [](int id) -> const std::string & { return ETEProtobufIds_Name(id); });
+    }
+
+    void NetMessageTrace::Record(uint32_t messageId, uint32_t bytes, uint32_t recipients) {
+        if (messageId < kMaxMessageId) {
+            g_Counts[messageId].fetch_add(1, std::memory_order_relaxed);
+            g_Bytes[messageId].fetch_add(static_cast<uint64_t>(bytes) * std::max(recipients, 1u),
+                                         std::memory_order_relaxed);
+        }
+
+        const uint64_t index = g_Head.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = g_Slots[index % kCapacity];
+
+        slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.record = {MonotonicNs(), g_ServerTick.load(std::memory_order_relaxed), messageId, bytes, recipients};
+
+        slot.seq.store(2 * index + 2, std::memory_order_release);
+    }
+
+    void NetMessageTrace::Advance() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!g_AdvanceStarted) {
+            g_AdvanceStarted = true;
+            g_LastAdvance = now;
+            return;
+        }
+        if (now - g_LastAdvance < std::chrono::seconds(1))
+            return;
+        g_LastAdvance = now;
+
+        size_t active = 0;
+        for (uint32_t id = 0; id < kMaxMessageId; ++id) {
+            const uint64_t count = g_Counts[id].load(std::memory_order_relaxed);
+            const uint64_t bytes = g_Bytes[id].load(std::memory_order_relaxed);
+            const uint64_t countDelta = count - g_PreviousCounts[id];
+            g_PreviousCounts[id] = count;
+
+            if (countDelta)
+                g_LastSecond[active++] = {id, static_cast<uint32_t>(countDelta), bytes - g_PreviousBytes[id]};
+            g_PreviousBytes[id] = bytes;
+        }
+
+        std::sort(g_LastSecond, g_LastSecond + active, [](const NetMessageRate &a, const NetMessageRate &b) {
+            return a.bytes > b.bytes;
+        });
+        g_LastSecondCount = active;
+    }
+
+    const char *NetMessageTrace::Name(uint32_t messageId) {
+        return messageId < kMaxMessageId && g_Names[messageId] ? g_Names[messageId] : "[unknown]";
+    }
+
+    size_t NetMessageTrace::LastSecond(NetMessageRate *out, size_t max) {
+        const size_t count = std::min(g_LastSecondCount, max);
+        std::copy_n(g_LastSecond, count, out);
+        return count;
+    }
+
+    size_t NetMessageTrace::Recent(NetMessageRecord *out, size_t max) {
+        const uint64_t head = g_Head.load(std::memory_order_acquire);
+        const uint64_t available = std::min<uint64_t>(head, kCapacity);
+        size_t written = 0;
+
+        for (uint64_t newest = 0; newest < available && written < max; ++newest) {
+            const uint64_t index = head - 1 - newest;
+            const Slot &slot = g_Slots[index % kCapacity];
+
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before != 2 * index + 2)
+                continue;
+
+            out[written] = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before)
+                ++written;
+        }
+
+        return written;
+    }
+}
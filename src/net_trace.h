@@ -0,0 +1,48 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    struct NetMessageRecord {
+        uint64_t timestampNs;
+        uint64_t tick;
+        uint32_t messageId;
+        uint32_t bytes;
+        uint32_t recipients;
+    };
+
+    struct NetMessageRate {
+        uint32_t messageId;
+        uint32_t count;
+        // Payload size multiplied by the number of recipients.
+        uint64_t bytes;
+    };
+
+    // Outgoing net/user message statistics. Record() only bumps per-type counters and pushes a small record into a
+    // lock-free ring, payloads are never parsed. Names come from the compiled protobuf enums.
+    class NetMessageTrace {
+    public:
+        static constexpr size_t kCapacity = 1024;
+        static constexpr uint32_t kMaxMessageId = 1024;
+
+        // Resolves the message names up front, so Name() is safe to use from the crash handler.
+        static void Init();
+
+        static void Record(uint32_t messageId, uint32_t bytes, uint32_t recipients);
+
+        static void Advance();
+
+        static const char *Name(uint32_t messageId);
+
+        // Message types of the last completed second, sorted by bytes sent.
+        static size_t LastSecond(NetMessageRate *out, size_t max);
+
+        // Copies up to max records into out, newest first.
+        static size_t Recent(NetMessageRecord *out, size_t max);
+    };
+}
@@ -0,0 +1,216 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "pressure_monitor.h"
+#include "helper_threads.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        struct MemoryEvents {
+            unsigned long long high = 0;
+            unsigned long long max = 0;
+            unsigned long long oom = 0;
+        };
+
+        PressureMonitorConfig g_Config;
+        std::mutex g_Mutex;
+        std::thread g_Thread;
+        int g_StopFd = -1;
+        std::string g_Source;
+
+        std::string CgroupDirectory() {
+            FILE *file = std::fopen("/proc/self/cgroup", "r");
+            if (!file)
+                return {};
+
+            // Only the unified (v2) hierarchy has memory.pressure and a single memory.events.
+            std::string directory;
+            char line[1024];
+            while (std::fgets(line, sizeof(line), file)) {
+                if (std::strncmp(line, "0::", 3) != 0)
+                    continue;
+                line[std::strcspn(line, "\n")] = '\0';
+                directory = std::string("/sys/fs/cgroup") + (std::strcmp(line + 3, "/") == 0 ? "" : line + 3);
+                break;
+            }
+            std::fclose(file);
+
+            return directory;
+        }
+
+        size_t ReadFile(const std::string &path, char *out, size_t size) {
+            const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return 0;
+
+            const ssize_t read = ::read(fd, out, size - 1);
+            close(fd);
+
+            out[read > 0 ? read : 0] = '\0';
+            return read > 0 ? static_cast<size_t>(read) : 0;
+        }
+
+        bool ReadMemoryEvents(const std::string &path, MemoryEvents &events) {
+            char text[512];
+            if (!ReadFile(path, text, sizeof(text)))
+                return false;
+
+            char *save = nullptr;
+            for (char *line = strtok_r(text, "\n", &save); line; line = strtok_r(nullptr, "\n", &save)) {
+                std::sscanf(line, "high %llu", &events.high);
+                std::sscanf(line, "max %llu", &events.max);
+                std::sscanf(line, "oom %llu", &events.oom);
+            }
+            return true;
+        }
+
+        // Opens a PSI trigger, the fd reports POLLPRI whenever the stall threshold is crossed within a window.
+        int OpenTrigger(const std::string &path) {
+            const int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0)
+                return -1;
+
+            char trigger[64];
+            const int len = std::snprintf(trigger, sizeof(trigger), "some %d %d", g_Config.stallMs * 1000,
+                                          g_Config.windowMs * 1000);
+            if (write(fd, trigger, len + 1) < 0) {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        void Report(const std::string &pressurePath, const std::string &eventsPath,
+                    std::chrono::steady_clock::time_point &lastReport) {
+            const auto now = std::chrono::steady_clock::now();
+            if (lastReport.time_since_epoch().count() != 0 && now - lastReport < std::chrono::seconds(g_Config.cooldownSec))
+                return;
+            lastReport = now;
+
+            char pressure[512] = "";
+            char events[512] = "";
+            ReadFile(pressurePath, pressure, sizeof(pressure));
+            ReadFile(eventsPath, events, sizeof(events));
+
+            char reason[1200];
+            std::snprintf(reason, sizeof(reason), "%s:\n%s%s:\n%s", pressurePath.c_str(), pressure, eventsPath.c_str(),
+                          events);
+
+            ACC_CORE_WARN("Memory pressure detected ({}), writing a snapshot.", pressurePath);
+            if (g_Config.onPressure)
+                g_Config.onPressure(reason);
+        }
+
+        void MonitorLoop(int triggerFd, std::string pressurePath, std::string eventsPath) {
+            HelperThreads::Enter("pressure");
+            std::chrono::steady_clock::time_point lastReport{};
+            MemoryEvents last{};
+            ReadMemoryEvents(eventsPath, last);
+
+            while (true) {
+                pollfd fds[2] = {{g_StopFd, POLLIN, 0}, {triggerFd, POLLPRI, 0}};
+                // Without a trigger memory.events is polled once per second instead.
+                const int ready = poll(fds, triggerFd >= 0 ? 2 : 1, triggerFd >= 0 ? -1 : 1000);
+                if (ready < 0 && errno != EINTR)
+                    break;
+                if (fds[0].revents & POLLIN)
+                    break;
+
+                if (triggerFd >= 0) {
+                    if (fds[1].revents & POLLERR) {
+                        ACC_CORE_WARN("Memory pressure trigger {} went away, monitor stopped.", pressurePath);
+                        break;
+                    }
+                    if (fds[1].revents & POLLPRI)
+                        Report(pressurePath, eventsPath, lastReport);
+                    continue;
+                }
+
+                MemoryEvents current{};
+                if (!ReadMemoryEvents(eventsPath, current))
+                    continue;
+                if (current.high > last.high || current.max > last.max || current.oom > last.oom)
+                    Report(pressurePath, eventsPath, lastReport);
+                last = current;
+            }
+
+            if (triggerFd >= 0)
+                close(triggerFd);
+        }
+    }
+
+    bool PressureMonitor::Start(const PressureMonitorConfig &config) {
+        std::lock_guard lock(g_Mutex);
+        if (g_Thread.joinable())
+            return false;
+
+        g_Config = config;
+        // The kernel only accepts windows between 500 ms and 10 s.
+        g_Config.windowMs = std::clamp(g_Config.windowMs, 500, 10000);
+        g_Config.stallMs = std::clamp(g_Config.stallMs, 1, g_Config.windowMs);
+
+        const std::string cgroup = CgroupDirectory();
+        std::string pressurePath = cgroup.empty() ? "" : cgroup + "/memory.pressure";
+        const std::string eventsPath = cgroup.empty() ? "" : cgroup + "/memory.events";
+
+        int triggerFd = pressurePath.empty() ? -1 : OpenTrigger(pressurePath);
+        if (triggerFd < 0) {
+            // Outside a memory-limited cgroup the system wide PSI still warns before the global OOM killer.
+            pressurePath = "/proc/pressure/memory";
+            triggerFd = OpenTrigger(pressurePath);
+        }
+
+        MemoryEvents events{};
+        if (triggerFd < 0 && !ReadMemoryEvents(eventsPath, events)) {
+            ACC_CORE_INFO("Neither PSI triggers nor cgroup memory.events are available, memory pressure monitor is off.");
+            return false;
+        }
+
+        g_StopFd = eventfd(0, EFD_CLOEXEC);
+        if (g_StopFd < 0) {
+            if (triggerFd >= 0)
+                close(triggerFd);
+            return false;
+        }
+
+        g_Source = triggerFd >= 0 ? pressurePath : eventsPath;
+        g_Thread = std::thread(MonitorLoop, triggerFd, pressurePath, eventsPath);
+
+        ACC_CORE_INFO("Memory pressure monitor watching {}", g_Source);
+        return true;
+    }
+
+    void PressureMonitor::Stop() {
+        std::lock_guard lock(g_Mutex);
+        if (!g_Thread.joinable())
+            return;
+
+        const uint64_t one = 1;
+        if (write(g_StopFd, &one, sizeof(one)) < 0)
+            ACC_CORE_WARN("Failed to signal the memory pressure monitor.");
+        g_Thread.join();
+
+        close(g_StopFd);
+        g_StopFd = -1;
+        g_Source.clear();
+    }
+
+    std::string PressureMonitor::Source() {
+        std::lock_guard lock(g_Mutex);
+        return g_Source;
+    }
+}
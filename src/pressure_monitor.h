@@ -0,0 +1,33 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <string>
+
+namespace acceleratorcss {
+    struct PressureMonitorConfig {
+        // Memory stall ("some") within one window that fires the PSI trigger. Unprivileged processes can only use
+        // windows that are a multiple of 2 s.
+        int stallMs = 300;
+        int windowMs = 2000;
+        // Minimum time between two snapshots, pressure usually lasts until the server is killed.
+        int cooldownSec = 300;
+        // Called on the monitor thread with the PSI and memory.events lines that explain the trigger.
+        void (*onPressure)(const char *reason) = nullptr;
+    };
+
+    // Watches the process' cgroup for memory pressure ahead of an OOM kill. Prefers a PSI trigger on the cgroup's
+    // memory.pressure (or /proc/pressure/memory) and falls back to polling the high/max/oom counters of
+    // memory.events when triggers are not available.
+    class PressureMonitor {
+    public:
+        static bool Start(const PressureMonitorConfig &config);
+
+        static void Stop();
+
+        // File being watched, empty when the monitor is not running.
+        static std::string Source();
+    };
+}
@@ -0,0 +1,256 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "sampler.h"
+#include "helper_threads.h"
+#include "log.h"
+#include "timing.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <dlfcn.h>
+#include <fstream>
+#include <pthread.h>
+#include <string_view>
+#include <thread>
+#include <ucontext.h>
+#include <unordered_map>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace acceleratorcss {
+    namespace {
+        constexpr uint64_t kRingSize = 4096;
+
+        struct Sample {
+            uint32_t depth;
+            uintptr_t pcs[StackSampler::kMaxDepth];
+        };
+
+        // Single producer (signal handler on the sampled thread), single consumer (export thread).
+        Sample g_Ring[kRingSize];
+        std::atomic<uint64_t> g_Head{0};
+        std::atomic<uint64_t> g_Tail{0};
+        std::atomic<uint64_t> g_Dropped{0};
+
+        uintptr_t g_StackLow = 0;
+        uintptr_t g_StackHigh = 0;
+
+        timer_t g_Timer{};
+        struct sigaction g_PreviousAction{};
+        std::atomic<bool> g_Running{false};
+        std::thread g_ExportThread;
+        SamplerConfig g_Config;
+
+        void OnSample(int, siginfo_t *, void *context) {
+            const uint64_t head = g_Head.load(std::memory_order_relaxed);
+            if (head - g_Tail.load(std::memory_order_acquire) >= kRingSize) {
+                g_Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            Sample &sample = g_Ring[head % kRingSize];
+            const auto *uc = static_cast<const ucontext_t *>(context);
+
+#if defined(__x86_64__)
+            uintptr_t fp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+            sample.pcs[0] = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+#else
+            uintptr_t fp = 0;
+            sample.pcs[0] = 0;
+#endif
+            uint32_t depth = 1;
+
+            // Only follow frame pointers that stay inside the thread's stack and keep growing towards its base, code
+            // built without frame pointers simply ends the walk early instead of faulting.
+            while (depth < StackSampler::kMaxDepth && fp >= g_StackLow && fp + 2 * sizeof(uintptr_t) <= g_StackHigh &&
+                   (fp & (sizeof(uintptr_t) - 1)) == 0) {
+                const auto *frame = reinterpret_cast<const uintptr_t *>(fp);
+                const uintptr_t next = frame[0];
+                const uintptr_t ret = frame[1];
+                if (!ret)
+                    break;
+
+                sample.pcs[depth++] = ret;
+                if (next <= fp)
+                    break;
+                fp = next;
+            }
+
+            sample.depth = depth;
+            g_Head.store(head + 1, std::memory_order_release);
+        }
+
+        std::string Symbolize(uintptr_t pc, std::unordered_map<uintptr_t, std::string> &cache) {
+            if (auto it = cache.find(pc); it != cache.end())
+                return it->second;
+
+            std::string frame;
+            Dl_info info{};
+            if (dladdr(reinterpret_cast<void *>(pc), &info) && info.dli_fname) {
+                std::string_view module(info.dli_fname);
+                if (auto slash = module.rfind('/'); slash != std::string_view::npos)
+                    module.remove_prefix(slash + 1);
+
+                char offset[32];
+                std::snprintf(offset, sizeof(offset), "+0x%lx",
+                              static_cast<unsigned long>(pc - reinterpret_cast<uintptr_t>(info.dli_fbase)));
+                frame.append(module).append(offset);
+            } else {
+                char raw[32];
+                std::snprintf(raw, sizeof(raw), "0x%lx", static_cast<unsigned long>(pc));
+                frame = raw;
+            }
+
+            cache.emplace(pc, frame);
+            return frame;
+        }
+
+        void Export(const std::unordered_map<std::string, uint64_t> &stacks,
+                    std::unordered_map<uintptr_t, std::string> &symbols) {
+            if (stacks.empty())
+                return;
+
+            static unsigned exportCount = 0;
+            char name[64];
+            std::snprintf(name, sizeof(name), "/profile_%ld_%u.folded", static_cast<long>(std::time(nullptr)),
+                          exportCount++);
+            const std::string path = g_Config.outputDirectory + name;
+
+            std::ofstream out(path, std::ios::out | std::ios::trunc);
+            if (!out.is_open()) {
+                ACC_CORE_ERROR("Failed to write stack samples: {}", path);
+                return;
+            }
+
+            for (const auto &[key, count]: stacks) {
+                const auto *pcs = reinterpret_cast<const uintptr_t *>(key.data());
+                const size_t depth = key.size() / sizeof(uintptr_t);
+
+                // Folded stacks are root first. Return addresses point after the call, so step back into it.
+                for (size_t i = depth; i-- > 0;) {
+                    out << Symbolize(i == 0 ? pcs[i] : pcs[i] - 1, symbols);
+                    out << (i ? ';' : ' ');
+                }
+                out << count << '\n';
+            }
+
+            ACC_CORE_INFO("Stack samples written to: {} (dropped {})", path, g_Dropped.exchange(0));
+        }
+
+        void ExportLoop() {
+            HelperThreads::Enter("sampler");
+            std::unordered_map<std::string, uint64_t> stacks;
+            std::unordered_map<uintptr_t, std::string> symbols;
+            auto lastExport = std::chrono::steady_clock::now();
+
+            while (true) {
+                const bool running = g_Running.load(std::memory_order_acquire);
+
+                const uint64_t head = g_Head.load(std::memory_order_acquire);
+                uint64_t tail = g_Tail.load(std::memory_order_relaxed);
+                for (; tail != head; ++tail) {
+                    const Sample &sample = g_Ring[tail % kRingSize];
+                    stacks[std::string(reinterpret_cast<const char *>(sample.pcs), sample.depth * sizeof(uintptr_t))]++;
+                }
+                g_Tail.store(tail, std::memory_order_release);
+
+                const auto now = std::chrono::steady_clock::now();
+                if (!running || now - lastExport >= std::chrono::seconds(g_Config.exportIntervalSec)) {
+                    Export(stacks, symbols);
+                    stacks.clear();
+                    lastExport = now;
+                }
+
+                if (!running)
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            }
+        }
+    }
+
+    bool StackSampler::Start(const SamplerConfig &config) {
+        if (g_Running.load())
+            return true;
+
+        g_Config = config;
+        if (g_Config.frequencyHz <= 0 || g_Config.frequencyHz > 1000)
+            g_Config.frequencyHz = 99;
+        if (g_Config.exportIntervalSec <= 0)
+            g_Config.exportIntervalSec = 60;
+
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+            void *stackAddr = nullptr;
+            size_t stackSize = 0;
+            pthread_attr_getstack(&attr, &stackAddr, &stackSize);
+            pthread_attr_destroy(&attr);
+            g_StackLow = reinterpret_cast<uintptr_t>(stackAddr);
+            g_StackHigh = g_StackLow + stackSize;
+        }
+
+        clockid_t cpuClock;
+        if (pthread_getcpuclockid(pthread_self(), &cpuClock) != 0) {
+            ACC_CORE_ERROR("Stack sampler: failed to get the thread CPU clock.");
+            return false;
+        }
+
+        struct sigaction act{};
+        act.sa_sigaction = OnSample;
+        act.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+        sigemptyset(&act.sa_mask);
+        sigaction(SIGPROF, &act, &g_PreviousAction);
+
+        sigevent sev{};
+        sev.sigev_notify = SIGEV_THREAD_ID;
+        sev.sigev_signo = SIGPROF;
+        sev.sigev_notify_thread_id = CurrentThreadId();
+
+        if (timer_create(cpuClock, &sev, &g_Timer) != 0) {
+            ACC_CORE_ERROR("Stack sampler: timer_create failed.");
+            sigaction(SIGPROF, &g_PreviousAction, nullptr);
+            return false;
+        }
+
+        const long intervalNs = 1000000000L / g_Config.frequencyHz;
+        itimerspec spec{};
+        spec.it_interval.tv_sec = intervalNs / 1000000000L;
+        spec.it_interval.tv_nsec = intervalNs % 1000000000L;
+        spec.it_value = spec.it_interval;
+
+        g_Running.store(true, std::memory_order_release);
+        g_ExportThread = std::thread(ExportLoop);
+        timer_settime(g_Timer, 0, &spec, nullptr);
+
+        ACC_CORE_INFO("Stack sampler started: {} Hz, exporting every {}s to {}", g_Config.frequencyHz,
+                      g_Config.exportIntervalSec, g_Config.outputDirectory);
+        return true;
+    }
+
+    void StackSampler::Stop() {
+        if (!g_Running.exchange(false))
+            return;
+
+        timer_delete(g_Timer);
+
+        // A SIGPROF still pending from the timer would be delivered under the previous action, usually SIG_DFL which
+        // terminates the process. Ignoring the signal first discards it.
+        struct sigaction ignore{};
+        ignore.sa_handler = SIG_IGN;
+        sigemptyset(&ignore.sa_mask);
+        sigaction(SIGPROF, &ignore, nullptr);
+        sigaction(SIGPROF, &g_PreviousAction, nullptr);
+
+        if (g_ExportThread.joinable())
+            g_ExportThread.join();
+    }
+
+    bool StackSampler::IsRunning() {
+        return g_Running.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,31 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace acceleratorcss {
+    struct SamplerConfig {
+        int frequencyHz = 99;
+        int exportIntervalSec = 60;
+        std::string outputDirectory;
+    };
+
+    // CPU-time sampling profiler for the game thread. A per-thread POSIX timer delivers SIGPROF to the calling
+    // thread, the handler walks frame pointers into a lock-free ring, and a helper thread aggregates the samples
+    // and periodically writes folded stacks (module+offset frames) that flamegraph.pl can render.
+    class StackSampler {
+    public:
+        static constexpr int kMaxDepth = 48;
+
+        // Must be called on the thread that should be sampled.
+        static bool Start(const SamplerConfig &config);
+
+        static void Stop();
+
+        static bool IsRunning();
+    };
+}
@@ -0,0 +1,180 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "sched_stats.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr uint64_t kBucketLimitsUs[SchedSummary::kBuckets - 1] = {50, 100, 250, 500, 1000, 2000, 5000, 10000, 25000};
+
+        struct Totals {
+            uint64_t cpuNs = 0;
+            uint64_t runDelayNs = 0;
+            uint64_t voluntarySwitches = 0;
+            uint64_t involuntarySwitches = 0;
+        };
+
+        struct HostCpu {
+            uint64_t steal = 0;
+            uint64_t total = 0;
+        };
+
+        // Everything below is only touched by the game thread.
+        int g_SchedstatFd = -1;
+        bool g_Opened = false;
+        Totals g_Previous;
+        bool g_HasPrevious = false;
+
+        SchedSummary g_Current{};
+        SchedSummary g_History[SchedStats::kHistorySeconds];
+        uint64_t g_HistoryCount = 0;
+        HostCpu g_LastHostCpu;
+        bool g_AdvanceStarted = false;
+        std::chrono::steady_clock::time_point g_LastAdvance;
+
+        bool ReadTotals(Totals &totals) {
+            // "<ns on cpu> <ns waiting on a runqueue> <timeslices>", kept open so a frame costs one pread.
+            char text[128];
+            const ssize_t read = g_SchedstatFd >= 0 ? pread(g_SchedstatFd, text, sizeof(text) - 1, 0) : -1;
+            if (read > 0) {
+                text[read] = '\0';
+                unsigned long long cpu = 0, delay = 0;
+                if (std::sscanf(text, "%llu %llu", &cpu, &delay) == 2) {
+                    totals.cpuNs = cpu;
+                    totals.runDelayNs = delay;
+                }
+            }
+
+            rusage usage{};
+            if (getrusage(RUSAGE_THREAD, &usage) != 0)
+                return read > 0;
+
+            totals.voluntarySwitches = usage.ru_nvcsw;
+            totals.involuntarySwitches = usage.ru_nivcsw;
+            if (read <= 0)
+                totals.cpuNs = static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1'000'000'000ull +
+                               static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ull;
+            return true;
+        }
+
+        bool ReadHostCpu(HostCpu &cpu) {
+            FILE *file = std::fopen("/proc/stat", "r");
+            if (!file)
+                return false;
+
+            unsigned long long values[8] = {};
+            const int read = std::fscanf(file, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &values[0], &values[1],
+                                         &values[2], &values[3], &values[4], &values[5], &values[6], &values[7]);
+            std::fclose(file);
+            if (read < 8)
+                return false;
+
+            cpu.steal = values[7];
+            cpu.total = 0;
+            for (unsigned long long value: values)
+                cpu.total += value;
+            return true;
+        }
+
+        size_t Bucket(uint64_t runDelayNs) {
+            const uint64_t us = runDelayNs / 1000;
+            return std::upper_bound(std::begin(kBucketLimitsUs), std::end(kBucketLimitsUs), us) - std::begin(kBucketLimitsUs);
+        }
+    }
+
+    SchedSample SchedStats::OnFrame() {
+        if (!g_Opened) {
+            g_Opened = true;
+            char path[64];
+            std::snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", CurrentThreadId());
+            g_SchedstatFd = open(path, O_RDONLY | O_CLOEXEC);
+        }
+
+        Totals totals;
+        if (!ReadTotals(totals))
+            return {};
+
+        const Totals previous = g_Previous;
+        const bool hasPrevious = g_HasPrevious;
+        g_Previous = totals;
+        g_HasPrevious = true;
+        if (!hasPrevious)
+            return {};
+
+        const SchedSample sample{
+            totals.cpuNs - previous.cpuNs,
+            totals.runDelayNs - previous.runDelayNs,
+            static_cast<uint32_t>(totals.voluntarySwitches - previous.voluntarySwitches),
+            static_cast<uint32_t>(totals.involuntarySwitches - previous.involuntarySwitches),
+        };
+
+        g_Current.ticks++;
+        g_Current.buckets[Bucket(sample.runDelayNs)]++;
+        g_Current.cpuNs += sample.cpuNs;
+        g_Current.runDelayNs += sample.runDelayNs;
+        g_Current.maxRunDelayNs = std::max(g_Current.maxRunDelayNs, sample.runDelayNs);
+        g_Current.voluntarySwitches += sample.voluntarySwitches;
+        g_Current.involuntarySwitches += sample.involuntarySwitches;
+        return sample;
+    }
+
+    void SchedStats::Advance() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!g_AdvanceStarted) {
+            g_AdvanceStarted = true;
+            g_LastAdvance = now;
+            ReadHostCpu(g_LastHostCpu);
+            return;
+        }
+        if (now - g_LastAdvance < std::chrono::seconds(1))
+            return;
+        g_LastAdvance = now;
+
+        HostCpu host;
+        if (ReadHostCpu(host)) {
+            g_Current.stealTicks = host.steal - g_LastHostCpu.steal;
+            g_Current.totalTicks = host.total - g_LastHostCpu.total;
+            g_LastHostCpu = host;
+        }
+
+        g_Current.seconds = 1;
+        g_History[g_HistoryCount % kHistorySeconds] = g_Current;
+        g_HistoryCount++;
+        g_Current = {};
+    }
+
+    bool SchedStats::Summary(uint32_t seconds, SchedSummary &out) {
+        out = {};
+        const size_t count = std::min<uint64_t>({g_HistoryCount, kHistorySeconds, seconds});
+
+        for (size_t i = 0; i < count; ++i) {
+            const SchedSummary &second = g_History[(g_HistoryCount - 1 - i) % kHistorySeconds];
+            out.seconds += second.seconds;
+            out.ticks += second.ticks;
+            for (size_t bucket = 0; bucket < SchedSummary::kBuckets; ++bucket)
+                out.buckets[bucket] += second.buckets[bucket];
+            out.cpuNs += second.cpuNs;
+            out.runDelayNs += second.runDelayNs;
+            out.maxRunDelayNs = std::max(out.maxRunDelayNs, second.maxRunDelayNs);
+            out.voluntarySwitches += second.voluntarySwitches;
+            out.involuntarySwitches += second.involuntarySwitches;
+            out.stealTicks += second.stealTicks;
+            out.totalTicks += second.totalTicks;
+        }
+
+        return count > 0;
+    }
+
+    uint64_t SchedStats::BucketLimitUs(size_t bucket) {
+        return bucket < std::size(kBucketLimitsUs) ? kBucketLimitsUs[bucket] : 0;
+    }
+}
@@ -0,0 +1,55 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    // What the scheduler did to the game thread during one tick.
+    struct SchedSample {
+        uint64_t cpuNs;
+        // Time the thread was runnable but waiting for a CPU.
+        uint64_t runDelayNs;
+        uint32_t voluntarySwitches;
+        uint32_t involuntarySwitches;
+    };
+
+    struct SchedSummary {
+        static constexpr size_t kBuckets = 10;
+
+        uint32_t seconds;
+        uint64_t ticks;
+        // Ticks by run queue delay, bucket i holds delays below SchedStats::BucketLimitUs(i).
+        uint64_t buckets[kBuckets];
+        uint64_t cpuNs;
+        uint64_t runDelayNs;
+        uint64_t maxRunDelayNs;
+        uint64_t voluntarySwitches;
+        uint64_t involuntarySwitches;
+        // Host wide CPU time stolen by the hypervisor, from /proc/stat.
+        uint64_t stealTicks;
+        uint64_t totalTicks;
+    };
+
+    // Game thread scheduling statistics from its schedstat and getrusage(RUSAGE_THREAD), sampled every frame and
+    // folded into a per-second histogram of run queue delay, so "the host was busy" can be told apart from "a
+    // plugin was slow".
+    class SchedStats {
+    public:
+        static constexpr size_t kHistorySeconds = 64;
+
+        // Called from GameFrame on the game thread, returns what happened since the previous call.
+        static SchedSample OnFrame();
+
+        static void Advance();
+
+        // Sums the last seconds completed seconds. Returns false when there is no history yet.
+        static bool Summary(uint32_t seconds, SchedSummary &out);
+
+        // Upper bound of bucket i in microseconds, the last bucket is unbounded and returns 0.
+        static uint64_t BucketLimitUs(size_t bucket);
+    };
+}
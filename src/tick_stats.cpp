@@ -0,0 +1,183 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "tick_stats.h"
+#include "log.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace acceleratorcss {
+    namespace {
+        struct PluginAllocations {
+            uint32_t nameId;
+            uint64_t bytes;
+            uint64_t bytesPerSec;
+        };
+
+        // Around 64 and 128 tick frame times, then the ranges slow ticks usually fall into.
+        constexpr uint64_t kTickBucketLimitsUs[TickHistogram::kBuckets - 1] = {5000,  7813,  10000, 15625, 20000,
+                                                                               33000, 50000, 100000, 250000};
+
+        uint64_t g_SlowTickNs = 50'000'000;
+
+        GcSnapshot g_Gc{};
+        // Sequence for ReadGc, odd while PublishGc is copying.
+        std::atomic<uint32_t> g_GcSequence{0};
+
+        // Only written by the game thread, relaxed loads are enough for a scrape.
+        std::atomic<uint64_t> g_TickBuckets[TickHistogram::kBuckets];
+        std::atomic<uint64_t> g_TickSumNs{0};
+        TickSample g_History[TickStats::kHistoryTicks];
+        uint64_t g_HistoryCount = 0;
+        uint64_t g_LastFrameNs = 0;
+
+        // Slow ticks are logged at most once per second, the rest are only counted.
+        uint64_t g_LastSlowLogNs = 0;
+        uint32_t g_SuppressedSlowTicks = 0;
+
+        PluginAllocations g_Plugins[TickStats::kMaxPlugins];
+        size_t g_PluginCount = 0;
+        uint64_t g_LastPluginPublishNs = 0;
+
+        void LogSlowTick(const TickSample &sample, const GcSnapshot &previous) {
+            const GcSnapshot &gc = sample.gc;
+            const SchedSample &sched = sample.sched;
+            ACC_CORE_WARN("Slow tick {}: {:.2f} ms (GC gen0/1/2 +{}/+{}/+{}, pause +{:.2f} ms, allocated +{} KB, heap {} MB; "
+                          "on CPU {:.2f} ms, run queue wait {:.2f} ms, switches {} voluntary/{} involuntary){}",
+                          sample.tick, static_cast<double>(sample.durationNs) / 1e6,
+                          gc.gen0Collections - previous.gen0Collections, gc.gen1Collections - previous.gen1Collections,
+                          gc.gen2Collections - previous.gen2Collections,
+                          static_cast<double>(gc.totalPauseNs - previous.totalPauseNs) / 1e6,
+                          (gc.allocatedBytes - previous.allocatedBytes) / 1024, gc.heapSizeBytes / (1024 * 1024),
+                          static_cast<double>(sched.cpuNs) / 1e6, static_cast<double>(sched.runDelayNs) / 1e6,
+                          sched.voluntarySwitches, sched.involuntarySwitches,
+                          g_SuppressedSlowTicks ? fmt::format(", {} more slow ticks suppressed", g_SuppressedSlowTicks)
+                                                : std::string());
+        }
+    }
+
+    void TickStats::SetSlowTickThresholdMs(uint32_t thresholdMs) {
+        g_SlowTickNs = static_cast<uint64_t>(thresholdMs) * 1'000'000;
+    }
+
+    void TickStats::PublishGc(const GcSnapshot &snapshot) {
+        const uint32_t sequence = g_GcSequence.load(std::memory_order_relaxed);
+        g_GcSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        g_Gc = snapshot;
+        g_GcSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void TickStats::PublishPluginAllocations(const uint32_t *nameIds, const uint64_t *bytes, size_t count) {
+        const uint64_t now = MonotonicNs();
+        const double elapsedSec = g_LastPluginPublishNs ? static_cast<double>(now - g_LastPluginPublishNs) / 1e9 : 0.0;
+        g_LastPluginPublishNs = now;
+
+        count = std::min(count, kMaxPlugins);
+        for (size_t i = 0; i < count; ++i) {
+            PluginAllocations *plugin = std::find_if(g_Plugins, g_Plugins + g_PluginCount, [&](const auto &entry) {
+                return entry.nameId == nameIds[i];
+            });
+            if (plugin == g_Plugins + g_PluginCount) {
+                if (g_PluginCount == kMaxPlugins)
+                    continue;
+                *plugin = {nameIds[i], bytes[i], 0};
+                ++g_PluginCount;
+                continue;
+            }
+
+            plugin->bytesPerSec = elapsedSec > 0.0 && bytes[i] >= plugin->bytes
+                                      ? static_cast<uint64_t>(static_cast<double>(bytes[i] - plugin->bytes) / elapsedSec)
+                                      : 0;
+            plugin->bytes = bytes[i];
+        }
+    }
+
+    void TickStats::OnFrame(uint64_t tick, const SchedSample &sched) {
+        const uint64_t now = MonotonicNs();
+        const uint64_t previousNs = g_LastFrameNs;
+        g_LastFrameNs = now;
+        if (!previousNs)
+            return;
+
+        const GcSnapshot previous = g_HistoryCount ? g_History[(g_HistoryCount - 1) % kHistoryTicks].gc : g_Gc;
+
+        TickSample &sample = g_History[g_HistoryCount % kHistoryTicks];
+        sample = {tick, now - previousNs, g_Gc, sched};
+        g_HistoryCount++;
+
+        const size_t bucket = std::upper_bound(std::begin(kTickBucketLimitsUs), std::end(kTickBucketLimitsUs),
+                                               sample.durationNs / 1000) - std::begin(kTickBucketLimitsUs);
+        g_TickBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        g_TickSumNs.fetch_add(sample.durationNs, std::memory_order_relaxed);
+
+        if (g_SlowTickNs == 0 || sample.durationNs < g_SlowTickNs)
+            return;
+
+        if (now - g_LastSlowLogNs < 1'000'000'000ull) {
+            g_SuppressedSlowTicks++;
+            return;
+        }
+
+        LogSlowTick(sample, previous);
+        g_LastSlowLogNs = now;
+        g_SuppressedSlowTicks = 0;
+    }
+
+    const GcSnapshot &TickStats::LatestGc() {
+        return g_Gc;
+    }
+
+    bool TickStats::ReadGc(GcSnapshot &out) {
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            const uint32_t before = g_GcSequence.load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+            if (before & 1)
+                continue;
+
+            out = g_Gc;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (g_GcSequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+
+    void TickStats::ReadTickHistogram(TickHistogram &out) {
+        // The count is derived from the buckets so it always matches their total, only the sum may be a frame off.
+        out.count = 0;
+        out.sumNs = g_TickSumNs.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < TickHistogram::kBuckets; ++i) {
+            out.buckets[i] = g_TickBuckets[i].load(std::memory_order_relaxed);
+            out.count += out.buckets[i];
+        }
+    }
+
+    uint64_t TickStats::TickBucketLimitUs(size_t bucket) {
+        return bucket < std::size(kTickBucketLimitsUs) ? kTickBucketLimitsUs[bucket] : 0;
+    }
+
+    size_t TickStats::Recent(TickSample *out, size_t max) {
+        const size_t count = std::min<uint64_t>({g_HistoryCount, kHistoryTicks, max});
+        for (size_t i = 0; i < count; ++i)
+            out[i] = g_History[(g_HistoryCount - 1 - i) % kHistoryTicks];
+        return count;
+    }
+
+    size_t TickStats::PluginRates(PluginAllocationRate *out, size_t max) {
+        const size_t count = std::min(g_PluginCount, max);
+        PluginAllocations sorted[kMaxPlugins];
+        std::copy_n(g_Plugins, g_PluginCount, sorted);
+        std::partial_sort(sorted, sorted + count, sorted + g_PluginCount, [](const auto &a, const auto &b) {
+            return a.bytesPerSec > b.bytesPerSec;
+        });
+
+        for (size_t i = 0; i < count; ++i)
+            out[i] = {sorted[i].nameId, sorted[i].bytesPerSec};
+        return count;
+    }
+}
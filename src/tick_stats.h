@@ -0,0 +1,82 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include "sched_stats.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    // Managed GC state, published by the C# plugin every tick. Layout is shared with GcSnapshot in the managed code.
+    struct GcSnapshot {
+        uint64_t allocatedBytes;
+        uint64_t heapSizeBytes;
+        uint64_t fragmentedBytes;
+        uint64_t totalPauseNs;
+        uint64_t lastPauseNs;
+        uint32_t gen0Collections;
+        uint32_t gen1Collections;
+        uint32_t gen2Collections;
+        uint32_t lastPauseGeneration;
+    };
+    static_assert(sizeof(GcSnapshot) == 56, "GcSnapshot must match the managed layout");
+
+    struct TickSample {
+        uint64_t tick;
+        uint64_t durationNs;
+        GcSnapshot gc;
+        SchedSample sched;
+    };
+
+    // Frame times since load, bucket i counts frames shorter than TickStats::TickBucketLimitUs(i).
+    struct TickHistogram {
+        static constexpr size_t kBuckets = 10;
+
+        uint64_t buckets[kBuckets];
+        uint64_t count;
+        uint64_t sumNs;
+    };
+
+    struct PluginAllocationRate {
+        uint32_t nameId;
+        uint64_t bytesPerSec;
+    };
+
+    // Per-tick history of frame times and the GC state around them. Everything runs on the game thread, the crash
+    // handler reads the fixed arrays directly.
+    class TickStats {
+    public:
+        static constexpr size_t kHistoryTicks = 256;
+        static constexpr size_t kMaxPlugins = 128;
+
+        static void SetSlowTickThresholdMs(uint32_t thresholdMs);
+
+        static void PublishGc(const GcSnapshot &snapshot);
+
+        // Bytes allocated so far by the callbacks of each plugin, published once per second by the managed side.
+        static void PublishPluginAllocations(const uint32_t *nameIds, const uint64_t *bytes, size_t count);
+
+        // Called from GameFrame, measures the time since the previous frame and logs it if it was slow, together with
+        // what the scheduler did to the game thread over the same interval.
+        static void OnFrame(uint64_t tick, const SchedSample &sched);
+
+        static const GcSnapshot &LatestGc();
+
+        // Lock-free copies for other threads (the metrics endpoint). The game thread never waits for a reader, a
+        // reader that keeps racing a publish gives up and returns false, as it does before the first publish.
+        static bool ReadGc(GcSnapshot &out);
+
+        static void ReadTickHistogram(TickHistogram &out);
+
+        // Upper bound of bucket i in microseconds, the last bucket is unbounded and returns 0.
+        static uint64_t TickBucketLimitUs(size_t bucket);
+
+        // Copies up to max samples into out, newest first.
+        static size_t Recent(TickSample *out, size_t max);
+
+        static size_t PluginRates(PluginAllocationRate *out, size_t max);
+    };
+}
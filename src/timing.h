@@ -0,0 +1,28 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace acceleratorcss {
+    // Incremented by GameFrame, stamped onto trace records so they can be matched to server ticks.
+    inline std::atomic<uint64_t> g_ServerTick{0};
+    inline std::atomic<int> g_GameThreadId{0};
+
+    inline uint64_t MonotonicNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    inline int CurrentThreadId() {
+        static thread_local int tid = static_cast<int>(syscall(SYS_gettid));
+        return tid;
+    }
+}
@@ -0,0 +1,184 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#include "trace_governor.h"
+#include "log.h"
+
+#include <algorithm>
+
+namespace acceleratorcss {
+    namespace {
+        constexpr uint64_t kSecondNs = 1'000'000'000;
+        // A restore that is undone within this time did not hold, the next one waits twice as long.
+        constexpr uint64_t kRestoreHoldNs = 60 * kSecondNs;
+        constexpr uint32_t kMaxRestoreSec = 600;
+
+        TraceControl g_Control{};
+        std::atomic<uint64_t> g_NativeNs{0};
+
+        // Written by the game thread, read by the metrics endpoint.
+        std::atomic<uint64_t> g_TotalFrameNs{0};
+        std::atomic<uint64_t> g_TotalNativeNs{0};
+        std::atomic<uint64_t> g_TotalManagedNs{0};
+        std::atomic<uint64_t> g_LevelChanges{0};
+
+        // Everything below is only touched by the game thread.
+        TraceGovernorConfig g_Config;
+        uint32_t g_RestoreSec = 10;
+        uint32_t g_CalmSeconds = 0;
+        uint64_t g_LastRestoreNs = 0;
+
+        uint64_t g_LastFrameNs = 0;
+        uint64_t g_SecondStartNs = 0;
+        TraceOverheadSecond g_Current{};
+        TraceOverheadSecond g_History[TraceGovernor::kHistorySeconds];
+        uint64_t g_HistoryCount = 0;
+
+        // The managed prefix calls into RegisterCallbackTraceBinary, so its time already contains the native time.
+        // The native counter alone only matters when the managed side does not report (older C# plugin).
+        uint64_t Overhead(uint64_t nativeNs, uint64_t managedNs) {
+            return std::max(nativeNs, managedNs);
+        }
+
+        void SetLevel(TraceLevel level) {
+            if (g_Control.level.exchange(static_cast<int32_t>(level), std::memory_order_relaxed) !=
+                static_cast<int32_t>(level))
+                g_LevelChanges.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Evaluate(const TraceOverheadSecond &second, uint64_t now) {
+            if (g_Config.budget <= 0 || second.frameNs == 0)
+                return;
+
+            const double share =
+                static_cast<double>(Overhead(second.nativeNs, second.managedNs)) / static_cast<double>(second.frameNs);
+            const TraceLevel level = TraceGovernor::Level();
+
+            if (share > g_Config.budget) {
+                g_CalmSeconds = 0;
+                if (level == TraceLevel::Sampling)
+                    return;
+
+                g_RestoreSec = g_LastRestoreNs && now - g_LastRestoreNs < kRestoreHoldNs
+                                   ? std::min(g_RestoreSec * 2, kMaxRestoreSec)
+                                   : g_Config.restoreSec;
+
+                const auto next = static_cast<TraceLevel>(static_cast<int32_t>(level) + 1);
+                SetLevel(next);
+                ACC_CORE_WARN("Callback tracing took {:.1f}% of tick time over the last second (budget {:.1f}%), "
+                              "switching from {} to {} tracing.", share * 100, g_Config.budget * 100,
+                              TraceGovernor::LevelName(level), TraceGovernor::LevelName(next));
+                return;
+            }
+
+            if (share >= g_Config.budget / 2 || level == g_Config.ceiling) {
+                g_CalmSeconds = 0;
+                return;
+            }
+
+            if (++g_CalmSeconds < g_RestoreSec)
+                return;
+
+            g_CalmSeconds = 0;
+            g_LastRestoreNs = now;
+            const auto previous = static_cast<TraceLevel>(static_cast<int32_t>(level) - 1);
+            SetLevel(previous);
+            ACC_CORE_INFO("Callback tracing stayed below {:.1f}% of tick time for {}s, restoring {} tracing.",
+                          g_Config.budget * 50, g_RestoreSec, TraceGovernor::LevelName(previous));
+        }
+    }
+
+    void TraceGovernor::Configure(const TraceGovernorConfig &config) {
+        g_Config = config;
+        g_Config.restoreSec = std::max(config.restoreSec, 1u);
+        g_RestoreSec = g_Config.restoreSec;
+        g_CalmSeconds = 0;
+        g_LastRestoreNs = 0;
+
+        g_Control.sampleEvery.store(static_cast<int32_t>(std::max(config.sampleEvery, 1u)), std::memory_order_relaxed);
+        g_Control.level.store(static_cast<int32_t>(config.ceiling), std::memory_order_relaxed);
+
+        if (config.budget > 0)
+            ACC_CORE_INFO("Trace overhead budget: {:.1f}% of tick time, sampling 1 in {} callbacks when exceeded.",
+                          config.budget * 100, std::max(config.sampleEvery, 1u));
+    }
+
+    TraceControl *TraceGovernor::Control() {
+        return &g_Control;
+    }
+
+    TraceLevel TraceGovernor::Level() {
+        return static_cast<TraceLevel>(g_Control.level.load(std::memory_order_relaxed));
+    }
+
+    void TraceGovernor::AddNativeNs(uint64_t ns) {
+        g_NativeNs.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void TraceGovernor::OnFrame() {
+        const uint64_t now = MonotonicNs();
+        const uint64_t nativeNs = g_NativeNs.exchange(0, std::memory_order_relaxed);
+        const uint64_t managedNs =
+            static_cast<uint64_t>(std::max<int64_t>(g_Control.managedNs.exchange(0, std::memory_order_relaxed), 0));
+
+        if (g_LastFrameNs == 0) {
+            g_LastFrameNs = now;
+            g_SecondStartNs = now;
+            return;
+        }
+
+        const uint64_t frameNs = now - g_LastFrameNs;
+        g_LastFrameNs = now;
+
+        g_TotalFrameNs.fetch_add(frameNs, std::memory_order_relaxed);
+        g_TotalNativeNs.fetch_add(nativeNs, std::memory_order_relaxed);
+        g_TotalManagedNs.fetch_add(managedNs, std::memory_order_relaxed);
+
+        g_Current.ticks++;
+        g_Current.frameNs += frameNs;
+        g_Current.nativeNs += nativeNs;
+        g_Current.managedNs += managedNs;
+        if (frameNs)
+            g_Current.maxTickShare = std::max(g_Current.maxTickShare, static_cast<double>(Overhead(nativeNs, managedNs)) /
+                                                                          static_cast<double>(frameNs));
+
+        if (now - g_SecondStartNs < kSecondNs)
+            return;
+        g_SecondStartNs = now;
+
+        g_Current.level = Level();
+        g_History[g_HistoryCount % kHistorySeconds] = g_Current;
+        g_HistoryCount++;
+        Evaluate(g_Current, now);
+        g_Current = {};
+    }
+
+    size_t TraceGovernor::Recent(TraceOverheadSecond *out, size_t max) {
+        const size_t count = std::min<uint64_t>({g_HistoryCount, kHistorySeconds, max});
+        for (size_t i = 0; i < count; ++i)
+            out[i] = g_History[(g_HistoryCount - 1 - i) % kHistorySeconds];
+        return count;
+    }
+
+    TraceOverheadTotals TraceGovernor::Totals() {
+        return {
+            g_TotalFrameNs.load(std::memory_order_relaxed),
+            g_TotalNativeNs.load(std::memory_order_relaxed),
+            g_TotalManagedNs.load(std::memory_order_relaxed),
+            g_LevelChanges.load(std::memory_order_relaxed),
+        };
+    }
+
+    const char *TraceGovernor::LevelName(TraceLevel level) {
+        switch (level) {
+            case TraceLevel::Full:
+                return "full";
+            case TraceLevel::Lightweight:
+                return "lightweight";
+            case TraceLevel::Sampling:
+                return "sampled";
+        }
+        return "unknown";
+    }
+}
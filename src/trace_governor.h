@@ -0,0 +1,98 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+#pragma once
+
+#include "timing.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace acceleratorcss {
+    // Ordered from most to least expensive, the governor only ever moves one step at a time.
+    enum class TraceLevel : int32_t {
+        Full,
+        Lightweight,
+        Sampling,
+    };
+
+    // Shared with TraceControl in the managed code, which reads the level on every traced call and adds the time its
+    // Harmony prefix and finalizer took.
+    struct TraceControl {
+        std::atomic<int32_t> level;
+        std::atomic<int32_t> sampleEvery;
+        std::atomic<int64_t> managedNs;
+    };
+    static_assert(sizeof(TraceControl) == 16, "TraceControl must match the managed layout");
+    static_assert(std::atomic<int64_t>::is_always_lock_free, "TraceControl is written by managed code");
+
+    struct TraceGovernorConfig {
+        // Share of tick time tracing may cost before it is degraded. 0 disables the governor.
+        double budget = 0.05;
+        // Level configured by the user, the governor never restores past it.
+        TraceLevel ceiling = TraceLevel::Full;
+        // Seconds below half the budget before a level is restored, doubled every time a restore does not hold.
+        uint32_t restoreSec = 10;
+        // In sampling mode only every n-th callback per thread is traced.
+        uint32_t sampleEvery = 16;
+    };
+
+    struct TraceOverheadSecond {
+        uint64_t ticks;
+        uint64_t frameNs;
+        uint64_t nativeNs;
+        uint64_t managedNs;
+        // Worst single tick, as a share of that tick's duration.
+        double maxTickShare;
+        TraceLevel level;
+    };
+
+    // Running totals since load, readable from any thread.
+    struct TraceOverheadTotals {
+        uint64_t frameNs;
+        uint64_t nativeNs;
+        uint64_t managedNs;
+        uint64_t levelChanges;
+    };
+
+    // Measures what callback tracing costs per tick and steps it down to lightweight and then sampled tracing when it
+    // takes more than its budget, stepping back up once the load is gone.
+    class TraceGovernor {
+    public:
+        static constexpr size_t kHistorySeconds = 64;
+
+        static void Configure(const TraceGovernorConfig &config);
+
+        static TraceControl *Control();
+
+        static TraceLevel Level();
+
+        static void AddNativeNs(uint64_t ns);
+
+        // Called from GameFrame on the game thread.
+        static void OnFrame();
+
+        // Copies up to max completed seconds into out, newest first.
+        static size_t Recent(TraceOverheadSecond *out, size_t max);
+
+        static TraceOverheadTotals Totals();
+
+        static const char *LevelName(TraceLevel level);
+    };
+
+    // Bills the enclosing native trace entry point to the governor.
+    class TraceOverheadScope {
+    public:
+        TraceOverheadScope() : m_start(MonotonicNs()) {}
+
+        ~TraceOverheadScope() { TraceGovernor::AddNativeNs(MonotonicNs() - m_start); }
+
+        TraceOverheadScope(const TraceOverheadScope &) = delete;
+        TraceOverheadScope &operator=(const TraceOverheadScope &) = delete;
+
+    private:
+        uint64_t m_start;
+    };
+}
@@ -0,0 +1,356 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+// Crash path test without a server: fills the callback trace ring and the other crash report sources with worst
+// case records, then forks one child per fault type. Each child installs a stand-in for Breakpad's handler (alternate
+// stack, fixed size fake minidump, CrashReport::Write, re-raise) and faults. The parent checks that every child died
+// from its signal within the timeout and left a complete .txt and .json report within the size and time limits.
+//
+// Usage: crash_test [output directory]
+//
+#include "callback_ingest.h"
+#include "callback_trace.h"
+#include "crash_report.h"
+#include "entity_snapshot.h"
+#include "exception_trace.h"
+#include "game_event_trace.h"
+#include "names.h"
+#include "sched_stats.h"
+#include "tick_stats.h"
+#include "timing.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using acceleratorcss::ArgTag;
+using acceleratorcss::CallbackFrame;
+using acceleratorcss::CallbackIngest;
+using acceleratorcss::CallbackTrace;
+using acceleratorcss::CallbackTraceRecord;
+using acceleratorcss::CrashContext;
+using acceleratorcss::CrashReport;
+using acceleratorcss::CrashReportFiles;
+using acceleratorcss::EntitySnapshot;
+using acceleratorcss::ExceptionTrace;
+using acceleratorcss::GameEventTrace;
+using acceleratorcss::GcSnapshot;
+using acceleratorcss::MonotonicNs;
+using acceleratorcss::NameTable;
+using acceleratorcss::SchedSample;
+using acceleratorcss::TickStats;
+
+namespace {
+    constexpr size_t kMethods = 64;
+    constexpr size_t kMinidumpBytes = 256 * 1024;
+    constexpr auto kChildTimeout = std::chrono::seconds(10);
+    // A full ring of full records is the largest report the handler can produce.
+    constexpr uint64_t kMaxReportBytes = 16ull * 1024 * 1024;
+    constexpr double kMaxReportMs = 500.0;
+
+    constexpr const char *kSections[] = {
+        "-------- CONFIG BEGIN --------\n",
+        "-------- CALLBACK TRACE BEGIN",
+        "-------- CALLBACK TRACE END --------\n",
+        "-------- CRASH HANDLER BEGIN --------\n",
+        "-------- CRASH HANDLER END --------\n",
+    };
+
+    enum class Fault {
+        Segv,
+        Abort,
+        Bus,
+        HeapCorruption,
+    };
+
+    struct FaultCase {
+        Fault fault;
+        const char *name;
+        int signal;
+        const char *signalName;
+    };
+
+    constexpr FaultCase kFaults[] = {
+        {Fault::Segv, "segv", SIGSEGV, "SIGSEGV"},
+        {Fault::Abort, "abort", SIGABRT, "SIGABRT"},
+        {Fault::Bus, "bus", SIGBUS, "SIGBUS"},
+        {Fault::HeapCorruption, "heap", SIGABRT, "SIGABRT"},
+    };
+
+    const int kHandledSignals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS};
+
+    uint32_t g_MethodIds[kMethods];
+    char g_MinidumpPath[512];
+    char g_Zeros[64 * 1024];
+    CrashReportFiles g_Files;
+    const CrashContext g_Context{"crash_test", "de_dust2", "/home/cs2/game", "./cs2 -dedicated +map de_dust2", ""};
+
+    // Same order of work as Breakpad: the minidump first, then the callback writes the reports and the signal is
+    // raised again with the default action, which SA_RESETHAND has already restored.
+    void OnFault(int signo, siginfo_t *, void *) {
+        const uint64_t startNs = MonotonicNs();
+
+        const int fd = open(g_MinidumpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            for (size_t written = 0; written < kMinidumpBytes; written += sizeof(g_Zeros)) {
+                if (write(fd, g_Zeros, sizeof(g_Zeros)) <= 0)
+                    break;
+            }
+            close(fd);
+        }
+
+        CallbackTrace::MarkCrashReported();
+        CrashReport::Write(g_MinidumpPath, g_Context, startNs, g_Files);
+        raise(signo);
+    }
+
+    void InstallHandler() {
+        static char altStack[256 * 1024];
+        stack_t stack{};
+        stack.ss_sp = altStack;
+        stack.ss_size = sizeof(altStack);
+        sigaltstack(&stack, nullptr);
+
+        struct sigaction action{};
+        action.sa_sigaction = OnFault;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        for (const int signo: kHandledSignals)
+            sigaddset(&action.sa_mask, signo);
+        for (const int signo: kHandledSignals)
+            sigaction(signo, &action, nullptr);
+    }
+
+    // The largest record the managed side can send: a full argument block and a 64 frame stack.
+    std::vector<uint8_t> FullPayload(uint32_t methodId) {
+        constexpr size_t kArgSize = 1 + sizeof(int64_t);
+        constexpr size_t kArgs = CallbackTraceRecord::kMaxArgBytes / kArgSize;
+        constexpr uint16_t argsLen = kArgs * kArgSize;
+        constexpr uint16_t frameCount = CallbackTraceRecord::kMaxFrames;
+        const int32_t managedTid = 1;
+
+        std::vector<uint8_t> bytes(CallbackIngest::kHeaderSize + argsLen + frameCount * sizeof(CallbackFrame));
+        std::memcpy(bytes.data(), &methodId, sizeof(methodId));
+        std::memcpy(bytes.data() + 4, &argsLen, sizeof(argsLen));
+        std::memcpy(bytes.data() + 6, &frameCount, sizeof(frameCount));
+        std::memcpy(bytes.data() + 8, &managedTid, sizeof(managedTid));
+
+        uint8_t *args = bytes.data() + CallbackIngest::kHeaderSize;
+        for (size_t i = 0; i < kArgs; ++i) {
+            const int64_t value = static_cast<int64_t>(i) * 1000;
+            args[i * kArgSize] = static_cast<uint8_t>(ArgTag::Int);
+            std::memcpy(args + i * kArgSize + 1, &value, sizeof(value));
+        }
+
+        uint8_t *frames = args + argsLen;
+        for (size_t i = 0; i < frameCount; ++i) {
+            const CallbackFrame frame{g_MethodIds[i % kMethods], static_cast<int32_t>(i * 4)};
+            std::memcpy(frames + i * sizeof(CallbackFrame), &frame, sizeof(frame));
+        }
+        return bytes;
+    }
+
+    // Fills every source the report reads, so each section is written at its largest.
+    void FillSources() {
+        for (size_t i = 0; i < kMethods; ++i) {
+            const std::string name = "CrashTest.Plugin.Callback" + std::to_string(i);
+            g_MethodIds[i] = NameTable::Intern(name.c_str(), name.size());
+        }
+
+        CallbackTrace::Resize(CallbackTrace::kMaxCapacity);
+        for (size_t i = 0; i < CallbackTrace::kMaxCapacity; ++i) {
+            acceleratorcss::g_ServerTick.store(i / 16);
+            const std::vector<uint8_t> payload = FullPayload(g_MethodIds[i % kMethods]);
+            CallbackIngest::Enter(payload.data(), payload.size());
+            // Every eighth callback stays open, so the longest running callback is reported as well.
+            if (i % 8)
+                CallbackIngest::Exit();
+        }
+
+        const std::string exceptionType = "System.NullReferenceException";
+        const uint32_t typeId = NameTable::Intern(exceptionType.c_str(), exceptionType.size());
+        for (size_t i = 0; i < ExceptionTrace::kCapacity; ++i)
+            ExceptionTrace::Record(typeId, g_MethodIds[i % kMethods], static_cast<int32_t>(0x80004003), 1);
+
+        for (size_t i = 0; i < GameEventTrace::kCapacity; ++i)
+            GameEventTrace::Record(i % 2 ? "player_hurt" : "weapon_fire");
+
+        GcSnapshot gc{};
+        gc.gen0Collections = 120;
+        gc.gen1Collections = 14;
+        gc.gen2Collections = 2;
+        gc.heapSizeBytes = 512ull * 1024 * 1024;
+        TickStats::PublishGc(gc);
+        for (uint64_t tick = 1; tick <= TickStats::kHistoryTicks; ++tick)
+            TickStats::OnFrame(tick, SchedSample{});
+
+        EntitySnapshot::Begin();
+        for (int i = 0; i < 2048; ++i)
+            EntitySnapshot::Add(i % 3 ? "cs_player_controller" : "prop_physics_multiplayer", i);
+        EntitySnapshot::Commit(acceleratorcss::g_ServerTick.load());
+    }
+
+    [[noreturn]] void RunChild(const FaultCase &test, const std::string &directory) {
+        // The test reads the reports, a core file of every child would only fill the disk.
+        const rlimit noCore{0, 0};
+        setrlimit(RLIMIT_CORE, &noCore);
+
+        std::snprintf(g_MinidumpPath, sizeof(g_MinidumpPath), "%s/%s.dmp", directory.c_str(), test.name);
+        acceleratorcss::g_GameThreadId.store(acceleratorcss::CurrentThreadId());
+        InstallHandler();
+
+        switch (test.fault) {
+            case Fault::Segv: {
+                volatile int *volatile target = nullptr;
+                *target = 1;
+                break;
+            }
+            case Fault::Abort:
+                std::abort();
+            case Fault::Bus: {
+                // Touching a mapped page past the end of a truncated file.
+                const std::string path = directory + "/bus.map";
+                const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+                const long page = sysconf(_SC_PAGESIZE);
+                if (fd < 0 || ftruncate(fd, page) != 0)
+                    break;
+                auto *volatile mapped = static_cast<char *>(mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                                                  fd, 0));
+                if (mapped == MAP_FAILED || ftruncate(fd, 0) != 0)
+                    break;
+                mapped[0] = 1;
+                break;
+            }
+            case Fault::HeapCorruption: {
+                // glibc detects the double free and aborts from inside free(), with the allocator in a bad state.
+                char *volatile block = static_cast<char *>(std::malloc(64));
+                std::free(block);
+                std::free(block);
+                break;
+            }
+        }
+
+        std::fprintf(stderr, "%s: the fault did not terminate the child\n", test.name);
+        _exit(2);
+    }
+
+    // Polls instead of blocking in waitpid, so a handler that hangs is killed and reported instead of hanging the run.
+    bool WaitForChild(pid_t pid, int &status, double &elapsedMs) {
+        const auto start = std::chrono::steady_clock::now();
+        while (true) {
+            const pid_t done = waitpid(pid, &status, WNOHANG);
+            elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (done == pid)
+                return true;
+            if (done < 0)
+                return false;
+
+            if (std::chrono::steady_clock::now() - start >= kChildTimeout) {
+                kill(pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    bool ReadFile(const std::string &path, std::string &out) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+            return false;
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        out = contents.str();
+        return true;
+    }
+
+    bool Check(const FaultCase &test, const std::string &directory) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return false;
+        }
+        if (pid == 0)
+            RunChild(test, directory);
+
+        int status = 0;
+        double elapsedMs = 0;
+        std::string failure;
+        if (!WaitForChild(pid, status, elapsedMs))
+            failure = "timed out";
+        else if (!WIFSIGNALED(status) || WTERMSIG(status) != test.signal)
+            failure = "did not die from " + std::string(test.signalName);
+
+        const std::string base = directory + "/" + test.name + ".dmp";
+        std::string text;
+        std::string json;
+        double reportMs = -1;
+        if (failure.empty() && !ReadFile(base + ".txt", text))
+            failure = "no .txt report";
+        if (failure.empty()) {
+            for (const char *section: kSections) {
+                if (text.find(section) == std::string::npos) {
+                    failure = "missing section " + std::string(section, std::strcspn(section, "\n"));
+                    break;
+                }
+            }
+        }
+        if (failure.empty()) {
+            const size_t line = text.find("This report: ");
+            if (line == std::string::npos || std::sscanf(text.c_str() + line, "This report: %lf ms", &reportMs) != 1)
+                failure = "no report timing";
+            else if (text.size() > kMaxReportBytes)
+                failure = "report over " + std::to_string(kMaxReportBytes) + " bytes";
+            else if (reportMs > kMaxReportMs)
+                failure = "report took over " + std::to_string(kMaxReportMs) + " ms";
+        }
+        if (failure.empty() && (!ReadFile(base + ".json", json) || json.size() < 2 ||
+                                json.compare(json.size() - 2, 2, "}\n") != 0))
+            failure = "no complete .json report";
+
+        std::printf("%-8s %8s %10.1f %12zu %10.1f  %s\n", test.name, test.signalName, reportMs, text.size(),
+                    elapsedMs, failure.empty() ? "OK" : failure.c_str());
+        return failure.empty();
+    }
+}
+
+int main(int argc, char **argv) {
+    std::string directory;
+    if (argc > 1) {
+        directory = argv[1];
+        mkdir(directory.c_str(), 0755);
+    } else {
+        char pattern[] = "/tmp/crash_test_XXXXXX";
+        if (!mkdtemp(pattern)) {
+            std::perror("mkdtemp");
+            return 1;
+        }
+        directory = pattern;
+    }
+
+    FillSources();
+    std::printf("Reports in %s, ring capacity %zu, limits %llu bytes and %.0f ms\n\n", directory.c_str(),
+                CallbackTrace::kMaxCapacity, static_cast<unsigned long long>(kMaxReportBytes), kMaxReportMs);
+    std::printf("%-8s %8s %10s %12s %10s  %s\n", "fault", "signal", "report ms", "report bytes", "child ms", "result");
+
+    bool passed = true;
+    for (const FaultCase &test: kFaults)
+        passed &= Check(test, directory);
+
+    std::printf("\n%s\n", passed ? "OK" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+//
+// Created by Michal Přikryl on 19.10.2026.
+// Copyright (c) 2026 slynxcz. All rights reserved.
+//
+// NetMessageTrace without the compiled protobufs for crash_test, the real one resolves its names from the SDK's
+// message enums. Nothing is recorded, the report section is written empty.
+//
+#include "net_trace.h"
+
+namespace acceleratorcss {
+    void NetMessageTrace::Init() {}
+
+    void NetMessageTrace::Record(uint32_t, uint32_t, uint32_t) {}
+
+    void NetMessageTrace::Advance() {}
+
+    const char *NetMessageTrace::Name(uint32_t) { return ""; }
+
+    size_t NetMessageTrace::LastSecond(NetMessageRate *, size_t) { return 0; }
+
+    size_t NetMessageTrace::Recent(NetMessageRecord *, size_t) { return 0; }
+}
@@ -40,6 +40,28 @@ target("AcceleratorCSS")
       path.join(MM_PATH, "core/sourcehook/sourcehook_impl_cvfnptr.cpp"),
       path.join(MM_PATH, "core/sourcehook/sourcehook_impl_cproto.cpp"),
       path.join(ROOT, "src", "log.cpp"),
+      path.join(ROOT, "src", "names.cpp"),
+      path.join(ROOT, "src", "net_trace.cpp"),
+      path.join(ROOT, "src", "callback_stats.cpp"),
+      path.join(ROOT, "src", "callback_stack.cpp"),
+      path.join(ROOT, "src", "callback_trace.cpp"),
+      path.join(ROOT, "src", "callback_ingest.cpp"),
+      path.join(ROOT, "src", "capture.cpp"),
+      path.join(ROOT, "src", "crash_report.cpp"),
+      path.join(ROOT, "src", "crash_upload.cpp"),
+      path.join(ROOT, "src", "entity_snapshot.cpp"),
+      path.join(ROOT, "src", "exception_trace.cpp"),
+      path.join(ROOT, "src", "game_event_trace.cpp"),
+      path.join(ROOT, "src", "gamedata.cpp"),
+      path.join(ROOT, "src", "helper_threads.cpp"),
+      path.join(ROOT, "src", "memory_tracker.cpp"),
+      path.join(ROOT, "src", "metrics_server.cpp"),
+      path.join(ROOT, "src", "pressure_monitor.cpp"),
+      path.join(ROOT, "src", "sched_stats.cpp"),
+      path.join(ROOT, "src", "commands.cpp"),
+      path.join(ROOT, "src", "sampler.cpp"),
+      path.join(ROOT, "src", "tick_stats.cpp"),
+      path.join(ROOT, "src", "trace_governor.cpp"),
       path.join(ROOT, "protobufs", "generated", "**.pb.cc"),
       "vendor/breakpad/src/common/dwarf_cfi_to_module.cc",
       "vendor/breakpad/src/common/dwarf_cu_to_module.cc",
@@ -56,7 +78,8 @@ target("AcceleratorCSS")
       "vendor/breakpad/src/common/dwarf/elf_reader.cc",
       "vendor/breakpad/src/common/linux/crc32.cc",
       "vendor/breakpad/src/common/linux/dump_symbols.cc",
-      "vendor/breakpad/src/common/linux/elf_symbols_to_module.cc"
+      "vendor/breakpad/src/common/linux/elf_symbols_to_module.cc",
+      "vendor/breakpad/src/common/linux/http_upload.cc"
   })
 
   add_headerfiles(
@@ -116,4 +139,62 @@ target("AcceleratorCSS")
       -- Metamod
       path.join(MM_PATH, "core"),
       path.join(MM_PATH, "core", "sourcehook")
-  })
\ No newline at end of file
+  })
+
+-- Microbenchmark of the trace ingestion path, built without the SDK or Metamod.
+-- xmake build trace_bench && xmake run trace_bench [ops per thread] [ring capacity]
+target("trace_bench")
+  set_kind("binary")
+  set_default(false)
+  set_languages("cxx20")
+  set_optimize("fastest")
+
+  add_files({
+      path.join(ROOT, "bench", "trace_ingest_bench.cpp"),
+      path.join(ROOT, "src", "log.cpp"),
+      path.join(ROOT, "src", "names.cpp"),
+      path.join(ROOT, "src", "callback_stats.cpp"),
+      path.join(ROOT, "src", "callback_stack.cpp"),
+      path.join(ROOT, "src", "callback_trace.cpp"),
+      path.join(ROOT, "src", "callback_ingest.cpp"),
+      path.join(ROOT, "src", "capture.cpp"),
+      path.join(ROOT, "src", "helper_threads.cpp"),
+      path.join(ROOT, "src", "trace_governor.cpp")
+  })
+
+  add_packages("fmt", "spdlog")
+  add_syslinks("pthread")
+  add_includedirs(path.join(ROOT, "src"))
+
+-- Crash path test: forks children that fault with the report writers installed and checks the reports they leave.
+-- xmake build crash_test && xmake run crash_test [output directory]
+target("crash_test")
+  set_kind("binary")
+  set_default(false)
+  set_languages("cxx20")
+  set_optimize("fastest")
+
+  add_files({
+      path.join(ROOT, "test", "crash_test.cpp"),
+      path.join(ROOT, "test", "net_trace_stub.cpp"),
+      path.join(ROOT, "src", "crash_report.cpp"),
+      path.join(ROOT, "src", "log.cpp"),
+      path.join(ROOT, "src", "names.cpp"),
+      path.join(ROOT, "src", "callback_stats.cpp"),
+      path.join(ROOT, "src", "callback_stack.cpp"),
+      path.join(ROOT, "src", "callback_trace.cpp"),
+      path.join(ROOT, "src", "callback_ingest.cpp"),
+      path.join(ROOT, "src", "capture.cpp"),
+      path.join(ROOT, "src", "helper_threads.cpp"),
+      path.join(ROOT, "src", "trace_governor.cpp"),
+      path.join(ROOT, "src", "entity_snapshot.cpp"),
+      path.join(ROOT, "src", "exception_trace.cpp"),
+      path.join(ROOT, "src", "game_event_trace.cpp"),
+      path.join(ROOT, "src", "memory_tracker.cpp"),
+      path.join(ROOT, "src", "sched_stats.cpp"),
+      path.join(ROOT, "src", "tick_stats.cpp")
+  })
+
+  add_packages("fmt", "spdlog")
+  add_syslinks("pthread")
+  add_includedirs(path.join(ROOT, "src"))